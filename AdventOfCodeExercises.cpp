@@ -0,0 +1,23 @@
+#include "AdventOfCodeExercises.h"
+
+namespace AdventOfCodeExercises
+{
+    const std::vector<ExerciseEntry>& GetExercises()
+    {
+        static const std::vector<ExerciseEntry> exercises = {
+            { "exercise5", CreateExercise5Solver },
+            { "exercise6", CreateExercise6Solver },
+            { "exercise7", CreateExercise7Solver },
+            { "exercise8", CreateExercise8Solver },
+            { "exercise9", CreateExercise9Solver },
+            { "exercise10", CreateExercise10Solver },
+            { "exercise11", CreateExercise11Solver },
+            { "exercise12", CreateExercise12Solver },
+            { "exercise13", CreateExercise13Solver },
+            { "exercise14", CreateExercise14Solver },
+            { "exercise15", CreateExercise15Solver },
+        };
+
+        return exercises;
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "AdventOfCodeUtils.h"
+
+// Entry points for driving the exercises as a library instead of through their own main().
+// Build the exercises with ADVENT_OF_CODE_NO_MAIN defined when linking them together.
+namespace AdventOfCodeExercises
+{
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise5Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise6Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise7Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise8Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise9Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise10Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise11Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise12Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise13Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise14Solver();
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> CreateExercise15Solver();
+
+    struct ExerciseEntry
+    {
+        // Directory (relative to the repository root) that holds the exercise and its input
+        const char* directory;
+        std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> (*create)();
+    };
+
+    const std::vector<ExerciseEntry>& GetExercises();
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+// Scoped timers and named counters for finding out where the time goes. All of it compiles to
+// nothing unless ADVENT_OF_CODE_INSTRUMENTATION is defined. When it is, the totals are written
+// as JSON when the program exits, to the file named by the ADVENT_OF_CODE_INSTRUMENTATION_OUTPUT
+// environment variable (instrumentation.json by default).
+//
+//   ADVENT_OF_CODE_SCOPED_TIMER("exercise14.build");      times the rest of the enclosing scope
+//   ADVENT_OF_CODE_COUNT("exercise14.drop_sand_steps");   adds one to a counter
+//   ADVENT_OF_CODE_COUNT_N("exercise14.sand", n);         adds n to a counter
+//
+// The names passed to those must be string literals, the metric is looked up the first time
+// and cached in a static, so a hot loop only pays for an atomic add. Phase timers take names
+// that are only known at runtime and look them up every time, which is fine for coarse phases:
+//
+//   ADVENT_OF_CODE_PHASE_TIMER(parseTimer, solver.GetName(), "parse");
+//   solver.Parse(lines);
+//   ADVENT_OF_CODE_STOP_TIMER(parseTimer);
+//
+// Timers also record the allocations made on their thread while they run. Those are only
+// counted when ADVENT_OF_CODE_TRACK_ALLOCATIONS is defined as well.
+
+#ifdef ADVENT_OF_CODE_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "AdventOfCodeUtils.h"
+
+namespace AdventOfCodeInstrumentation
+{
+    // Counters only use count
+    struct Metric
+    {
+        std::atomic<uint64_t> count{ 0 };
+        std::atomic<uint64_t> totalNs{ 0 };
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> allocatedBytes{ 0 };
+    };
+
+    class Registry
+    {
+    public:
+        static Registry& Get()
+        {
+            // Never destroyed, so metrics stay valid while the results are written at exit
+            static Registry* const registry = new Registry();
+            return *registry;
+        }
+
+        Metric* GetTimer(const std::string& name)
+        {
+            return GetMetric(m_timers, name);
+        }
+
+        Metric* GetCounter(const std::string& name)
+        {
+            return GetMetric(m_counters, name);
+        }
+
+        void WriteJson(std::ostream& output)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            output << "{\n";
+            output << "  \"peak_rss_bytes\": " << AdventOfCodeUtils::GetPeakResidentBytes() << ",\n";
+            output << "  \"timers\": {\n";
+            for (auto it = m_timers.begin(); it != m_timers.end(); ++it)
+            {
+                output << "    " << AdventOfCodeUtils::EscapeJsonString(it->first)
+                       << ": { \"calls\": " << it->second->count.load()
+                       << ", \"total_ns\": " << it->second->totalNs.load()
+                       << ", \"allocations\": " << it->second->allocations.load()
+                       << ", \"allocated_bytes\": " << it->second->allocatedBytes.load() << " }"
+                       << (std::next(it) != m_timers.end() ? "," : "") << "\n";
+            }
+            output << "  },\n";
+            output << "  \"counters\": {\n";
+            for (auto it = m_counters.begin(); it != m_counters.end(); ++it)
+            {
+                output << "    " << AdventOfCodeUtils::EscapeJsonString(it->first)
+                       << ": " << it->second->count.load()
+                       << (std::next(it) != m_counters.end() ? "," : "") << "\n";
+            }
+            output << "  }\n";
+            output << "}\n";
+        }
+
+    private:
+        typedef std::map<std::string, std::unique_ptr<Metric> > MetricMap;
+
+        Registry()
+        {
+            std::atexit(&Registry::WriteAtExit);
+        }
+
+        static void WriteAtExit()
+        {
+            const char* filename = std::getenv("ADVENT_OF_CODE_INSTRUMENTATION_OUTPUT");
+            std::ofstream output(filename ? filename : "instrumentation.json");
+            Get().WriteJson(output);
+        }
+
+        Metric* GetMetric(MetricMap& metrics, const std::string& name)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& metric = metrics[name];
+            if (!metric)
+                metric = std::make_unique<Metric>();
+
+            return metric.get();
+        }
+
+        std::mutex m_mutex;
+        MetricMap m_timers;
+        MetricMap m_counters;
+    };
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(Metric* metric)
+            : m_metric(metric)
+            , m_startAllocations(AdventOfCodeUtils::GetThreadAllocations())
+            , m_start(std::chrono::steady_clock::now())
+        {}
+
+        ~ScopedTimer()
+        {
+            Stop();
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        // Records the time so far. Does nothing if the timer was already stopped.
+        void Stop()
+        {
+            if (!m_metric)
+                return;
+
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_metric->count.fetch_add(1, std::memory_order_relaxed);
+            m_metric->totalNs.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), std::memory_order_relaxed);
+
+            const auto allocations = AdventOfCodeUtils::GetThreadAllocations();
+            m_metric->allocations.fetch_add(allocations.count - m_startAllocations.count, std::memory_order_relaxed);
+            m_metric->allocatedBytes.fetch_add(allocations.bytes - m_startAllocations.bytes, std::memory_order_relaxed);
+            m_metric = nullptr;
+        }
+
+    private:
+        Metric* m_metric;
+        const AdventOfCodeUtils::AllocationStatistics m_startAllocations;
+        const std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#define ADVENT_OF_CODE_CONCAT_INNER(a, b) a##b
+#define ADVENT_OF_CODE_CONCAT(a, b) ADVENT_OF_CODE_CONCAT_INNER(a, b)
+
+#define ADVENT_OF_CODE_SCOPED_TIMER(name) \
+    static AdventOfCodeInstrumentation::Metric* const ADVENT_OF_CODE_CONCAT(timerMetric, __LINE__) = \
+        AdventOfCodeInstrumentation::Registry::Get().GetTimer(name); \
+    AdventOfCodeInstrumentation::ScopedTimer ADVENT_OF_CODE_CONCAT(scopedTimer, __LINE__)( \
+        ADVENT_OF_CODE_CONCAT(timerMetric, __LINE__))
+
+#define ADVENT_OF_CODE_COUNT_N(name, n) \
+    do \
+    { \
+        static AdventOfCodeInstrumentation::Metric* const counterMetric = \
+            AdventOfCodeInstrumentation::Registry::Get().GetCounter(name); \
+        counterMetric->count.fetch_add((n), std::memory_order_relaxed); \
+    } while (0)
+
+#define ADVENT_OF_CODE_COUNT(name) ADVENT_OF_CODE_COUNT_N(name, 1)
+
+#define ADVENT_OF_CODE_PHASE_TIMER(timer, exercise, phase) \
+    AdventOfCodeInstrumentation::ScopedTimer timer( \
+        AdventOfCodeInstrumentation::Registry::Get().GetTimer(std::string(exercise) + "." + (phase)))
+
+#define ADVENT_OF_CODE_STOP_TIMER(timer) timer.Stop()
+
+#else
+
+#define ADVENT_OF_CODE_SCOPED_TIMER(name) do {} while (0)
+#define ADVENT_OF_CODE_COUNT_N(name, n) do {} while (0)
+#define ADVENT_OF_CODE_COUNT(name) do {} while (0)
+#define ADVENT_OF_CODE_PHASE_TIMER(timer, exercise, phase) do {} while (0)
+#define ADVENT_OF_CODE_STOP_TIMER(timer) do {} while (0)
+
+#endif
@@ -1,27 +1,797 @@
+#include "AdventOfCodeUtils.h"
+#include "AdventOfCodeInstrumentation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include <fstream>
-#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-using namespace std;
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace AdventOfCodeUtils
 {
-    vector<string> ReadTextFile(string input_filename)
+    MappedFile::MappedFile(const std::string& filename)
+        : m_data(nullptr)
+        , m_size(0)
+        , m_isOpen(false)
+    {
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat fileInfo;
+        if (fstat(fd, &fileInfo) == 0)
+        {
+            m_isOpen = true;
+
+            // mmap refuses zero length mappings, an empty file simply has no lines
+            if (fileInfo.st_size > 0)
+            {
+                void* mapping = mmap(nullptr, fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    madvise(mapping, fileInfo.st_size, MADV_SEQUENTIAL);
+                    m_data = static_cast<const char*>(mapping);
+                    m_size = fileInfo.st_size;
+                }
+                else
+                {
+                    m_isOpen = false;
+                }
+            }
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        close(fd);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data)
+            munmap(const_cast<char*>(m_data), m_size);
+    }
+
+    MappedTextFile::MappedTextFile(const std::string& filename)
+        : m_file(filename)
+    {
+        IndexLines();
+    }
+
+    MappedTextFile::~MappedTextFile() = default;
+
+    void MappedTextFile::IndexLines()
+    {
+        const char* lineStart = m_file.GetData();
+        const char* const end = lineStart + m_file.GetSize();
+        while (lineStart < end)
+        {
+            const auto* newline = static_cast<const char*>(memchr(lineStart, '\n', end - lineStart));
+            const char* lineEnd = newline ? newline : end;
+            m_lines.emplace_back(lineStart, lineEnd - lineStart);
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    StreamingLineReader::StreamingLineReader(const int fd, const size_t bufferSize)
+        : m_fd(fd)
+        , m_buffer(bufferSize)
+        , m_lineStart(0)
+        , m_searchStart(0)
+        , m_end(0)
+        , m_endOfInput(false)
+    {}
+
+    bool StreamingLineReader::NextLine(std::string_view& line)
+    {
+        while (true)
+        {
+            // Only look at the bytes that arrived since the last search
+            const char* const data = m_buffer.data();
+            const auto* newline = static_cast<const char*>(memchr(data + m_searchStart, '\n', m_end - m_searchStart));
+            if (newline)
+            {
+                line = std::string_view(data + m_lineStart, newline - (data + m_lineStart));
+                m_lineStart = m_searchStart = newline - data + 1;
+                return true;
+            }
+
+            m_searchStart = m_end;
+            if (m_endOfInput || !Refill())
+            {
+                // The last line doesn't need a newline
+                if (m_lineStart == m_end)
+                    return false;
+
+                line = std::string_view(m_buffer.data() + m_lineStart, m_end - m_lineStart);
+                m_lineStart = m_searchStart = m_end;
+                return true;
+            }
+        }
+    }
+
+    bool StreamingLineReader::NextBytes(std::string_view& bytes)
+    {
+        // Whatever is left behind the last line goes out first
+        if (m_lineStart == m_end && (m_endOfInput || !Refill()))
+            return false;
+
+        bytes = std::string_view(m_buffer.data() + m_lineStart, m_end - m_lineStart);
+        m_lineStart = m_searchStart = m_end;
+        return true;
+    }
+
+    bool StreamingLineReader::Refill()
+    {
+        // Move the partial line to the front to make room behind it, and only grow the buffer
+        // when the partial line already fills it
+        if (m_lineStart > 0)
+        {
+            memmove(m_buffer.data(), m_buffer.data() + m_lineStart, m_end - m_lineStart);
+            m_end -= m_lineStart;
+            m_searchStart -= m_lineStart;
+            m_lineStart = 0;
+        }
+        else if (m_end == m_buffer.size())
+        {
+            m_buffer.resize(m_buffer.size() * 2);
+        }
+
+        while (true)
+        {
+            const auto bytesRead = read(m_fd, m_buffer.data() + m_end, m_buffer.size() - m_end);
+            if (bytesRead > 0)
+            {
+                m_end += bytesRead;
+                return true;
+            }
+
+            if (bytesRead < 0 && errno == EINTR)
+                continue;
+
+            m_endOfInput = true;
+            return false;
+        }
+    }
+
+#ifdef ADVENT_OF_CODE_ZLIB
+    DecompressingReader::DecompressingReader(const std::string& filename, const size_t numBuffers, const size_t bufferSize)
+        : m_file(gzopen(filename.c_str(), "rb"))
+        , m_buffers(std::max<size_t>(1, numBuffers), std::vector<char>(bufferSize))
+        , m_bufferSizes(m_buffers.size(), 0)
+        , m_numFilled(0)
+        , m_numConsumed(0)
+        , m_holdingBuffer(false)
+        , m_finished(false)
+        , m_failed(false)
+        , m_stopping(false)
+    {
+        if (!m_file)
+            return;
+
+        // zlib's own buffer only needs to be big enough to keep inflate busy
+        gzbuffer(m_file, 128 * 1024);
+        m_decompressor = std::thread(&DecompressingReader::Decompress, this);
+    }
+
+    DecompressingReader::~DecompressingReader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_bufferFreed.notify_one();
+        if (m_decompressor.joinable())
+            m_decompressor.join();
+
+        if (m_file)
+            gzclose(m_file);
+    }
+
+    bool DecompressingReader::NextBytes(std::string_view& bytes)
+    {
+        if (!m_file)
+            return false;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_holdingBuffer)
+        {
+            m_numConsumed++;
+            m_holdingBuffer = false;
+            m_bufferFreed.notify_one();
+        }
+
+        m_bufferFilled.wait(lock, [this] { return m_numFilled > m_numConsumed || m_finished; });
+        if (m_numFilled == m_numConsumed)
+            return false;
+
+        const auto index = m_numConsumed % m_buffers.size();
+        bytes = std::string_view(m_buffers[index].data(), m_bufferSizes[index]);
+        m_holdingBuffer = true;
+        return true;
+    }
+
+    bool DecompressingReader::HasFailed() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed;
+    }
+
+    void DecompressingReader::Decompress()
+    {
+        while (true)
+        {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_bufferFreed.wait(lock, [this] { return m_numFilled - m_numConsumed < m_buffers.size() || m_stopping; });
+                if (m_stopping)
+                    return;
+
+                index = m_numFilled % m_buffers.size();
+            }
+
+            // The reader doesn't look at a buffer until it's counted as filled, so it can be
+            // written without holding the lock
+            auto& buffer = m_buffers[index];
+            const auto bytesRead = gzread(m_file, buffer.data(), static_cast<unsigned>(buffer.size()));
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (bytesRead <= 0)
+            {
+                // A truncated file only shows up as an error once the data runs out
+                int error = Z_OK;
+                gzerror(m_file, &error);
+                m_failed = bytesRead < 0 || error != Z_OK;
+                m_finished = true;
+                m_bufferFilled.notify_one();
+                return;
+            }
+
+            m_bufferSizes[index] = bytesRead;
+            m_numFilled++;
+            m_bufferFilled.notify_one();
+        }
+    }
+#endif
+
+    size_t FindDelimiter(std::string_view input, size_t position, const char delimiter)
+    {
+        const char* data = input.data();
+        const size_t size = input.size();
+
+#if defined(__SSE2__)
+        const __m128i needle = _mm_set1_epi8(delimiter);
+        while (position + 16 <= size)
+        {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+            const int matches = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+            if (matches != 0)
+                return position + __builtin_ctz(matches);
+
+            position += 16;
+        }
+#endif
+
+        for (; position < size; ++position)
+        {
+            if (data[position] == delimiter)
+                return position;
+        }
+
+        return std::string_view::npos;
+    }
+
+    size_t SplitInto(std::string_view input, const char delimiter, std::vector<std::string_view>& tokens)
+    {
+        tokens.clear();
+
+        Tokenizer tokenizer(input, delimiter);
+        std::string_view token;
+        while (tokenizer.Next(token))
+        {
+            tokens.push_back(token);
+        }
+
+        return tokens.size();
+    }
+
+    static const size_t hugePageSize = 2 * 1024 * 1024;
+
+    void* HugePageMemoryResource::do_allocate(size_t bytes, size_t alignment)
+    {
+        // mmap only guarantees page alignment
+        assert(alignment <= 4096);
+        const auto size = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            throw std::bad_alloc();
+
+        // Only a hint, the kernel falls back to normal pages if it has no huge ones to spare
+        madvise(memory, size, MADV_HUGEPAGE);
+        return memory;
+    }
+
+    void HugePageMemoryResource::do_deallocate(void* memory, size_t bytes, size_t)
+    {
+        const auto size = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+        munmap(memory, size);
+    }
+
+    NodeArena::NodeArena(const bool useHugePages)
+        : m_resource(
+            useHugePages ? hugePageSize : 64 * 1024,
+            useHugePages ? static_cast<std::pmr::memory_resource*>(&m_hugePages) : std::pmr::new_delete_resource())
+    {}
+
+    std::string_view NodeArena::CopyString(std::string_view str)
+    {
+        char* copy = static_cast<char*>(m_resource.allocate(str.size(), 1));
+        std::copy(str.begin(), str.end(), copy);
+        return std::string_view(copy, str.size());
+    }
+
+    // Lets Submit tell whether it is being called from one of the pool's own workers
+    static thread_local const ThreadPool* currentPool = nullptr;
+    static thread_local size_t currentWorkerIndex = 0;
+
+    ThreadPool::ThreadPool(const size_t numThreads)
+        : m_nextQueue(0)
+        , m_unclaimedTasks(0)
+        , m_unfinishedTasks(0)
+        , m_stopping(false)
+    {
+        // hardware_concurrency is allowed to return 0 when it doesn't know
+        const auto threadCount = std::max<size_t>(1, numThreads);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        Wait();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_workAvailable.notify_all();
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::Submit(Task task)
+    {
+        const auto queueIndex = currentPool == this
+            ? currentWorkerIndex
+            : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+        {
+            std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+            m_queues[queueIndex]->tasks.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_unclaimedTasks++;
+            m_unfinishedTasks++;
+        }
+
+        m_workAvailable.notify_one();
+    }
+
+    void ThreadPool::Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_allDone.wait(lock, [this] { return m_unfinishedTasks == 0; });
+    }
+
+    void ThreadPool::WorkerLoop(const size_t workerIndex)
     {
-        ifstream myfile;
-        string line;
+        currentPool = this;
+        currentWorkerIndex = workerIndex;
 
-        vector<string> output;
-        myfile.open(input_filename);
-        if (myfile.is_open())
+        while (true)
         {
-            while (getline(myfile,line))
             {
-                output.push_back(string(line));
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_workAvailable.wait(lock, [this] { return m_unclaimedTasks > 0 || m_stopping; });
+                if (m_unclaimedTasks == 0)
+                    return;
+
+                m_unclaimedTasks--;
+            }
+
+            // A task was pushed before it was counted, so having claimed one means there is
+            // one sitting in some queue, even if another worker beats us to our own queue
+            Task task;
+            while (!TryPop(workerIndex, task))
+            {
+                std::this_thread::yield();
             }
 
-            myfile.close();
+            task();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_unfinishedTasks--;
+            if (m_unfinishedTasks == 0)
+                m_allDone.notify_all();
+        }
+    }
+
+    bool ThreadPool::TryPop(const size_t workerIndex, Task& task)
+    {
+        // Newest first from our own queue, it's the most likely to still be in the cache
+        {
+            auto& own = *m_queues[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        // Oldest first when stealing, that's usually the biggest chunk of work left
+        for (size_t i = 1; i < m_queues.size(); ++i)
+        {
+            auto& victim = *m_queues[(workerIndex + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+#ifdef ADVENT_OF_CODE_TRACK_ALLOCATIONS
+    // Thread local so counting doesn't need atomics and each phase only sees its own thread
+    static thread_local uint64_t threadAllocationCount = 0;
+    static thread_local uint64_t threadAllocatedBytes = 0;
+
+    static void* TrackedAllocate(const size_t size, const size_t alignment)
+    {
+        threadAllocationCount++;
+        threadAllocatedBytes += size;
+
+        // aligned_alloc wants the size to be a multiple of the alignment
+        return alignment <= alignof(std::max_align_t)
+            ? malloc(size ? size : 1)
+            : aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+#endif
+
+    bool IsAllocationTrackingEnabled()
+    {
+#ifdef ADVENT_OF_CODE_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    AllocationStatistics GetThreadAllocations()
+    {
+#ifdef ADVENT_OF_CODE_TRACK_ALLOCATIONS
+        return { threadAllocationCount, threadAllocatedBytes };
+#else
+        return { 0, 0 };
+#endif
+    }
+
+    uint64_t GetPeakResidentBytes()
+    {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0;
+
+        // Linux reports kilobytes
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    }
+
+    // Converts 8 ASCII digits loaded little endian (first digit in the lowest byte) into their
+    // value. Each step combines neighbouring lanes into lanes twice as wide.
+    static uint64_t ConvertEightDigits(uint64_t chunk)
+    {
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+        chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+        chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000FFFFFFFFULL;
+        return chunk;
+    }
+
+    static bool AreEightDigits(const uint64_t chunk)
+    {
+        // Every byte must be 0x30-0x39: the high nibble is 3, and adding 6 doesn't carry into it
+        return (chunk & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL &&
+            ((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) == 0x3030303030303030ULL;
+    }
+
+    bool ParseDigits(std::string_view digits, uint64_t& value)
+    {
+        if (digits.empty())
+            return false;
+
+        // Leading zeros don't count towards the 19 digit limit
+        while (digits.size() > 1 && digits.front() == '0')
+        {
+            digits.remove_prefix(1);
         }
-        return output;
+
+        if (digits.size() > 19)
+            return false;
+
+        const char* data = digits.data();
+        size_t remaining = digits.size();
+        uint64_t result = 0;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while (remaining >= 8)
+        {
+            uint64_t chunk;
+            memcpy(&chunk, data, sizeof(chunk));
+            if (!AreEightDigits(chunk))
+                return false;
+
+            result = result * 100000000 + ConvertEightDigits(chunk);
+            data += 8;
+            remaining -= 8;
+        }
+#endif
+
+        for (; remaining > 0; --remaining, ++data)
+        {
+            const auto digit = static_cast<unsigned char>(*data - '0');
+            if (digit > 9)
+                return false;
+
+            result = result * 10 + digit;
+        }
+
+        value = result;
+        return true;
     }
-}
\ No newline at end of file
+
+    std::string EscapeJsonString(std::string_view input)
+    {
+        std::string escaped;
+        escaped.reserve(input.size() + 2);
+        escaped.push_back('"');
+        for (const auto c : input)
+        {
+            switch (c)
+            {
+            case '"':
+                escaped.append("\\\"");
+                break;
+            case '\\':
+                escaped.append("\\\\");
+                break;
+            case '\n':
+                escaped.append("\\n");
+                break;
+            case '\t':
+                escaped.append("\\t");
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char controlCharacter[8];
+                    snprintf(controlCharacter, sizeof(controlCharacter), "\\u%04x", c);
+                    escaped.append(controlCharacter);
+                }
+                else
+                {
+                    escaped.push_back(c);
+                }
+                break;
+            }
+        }
+
+        escaped.push_back('"');
+        return escaped;
+    }
+
+    static void PrintAnswers(const Answers& answers)
+    {
+        // Some exercises only implement one of the two parts
+        if (!answers.part1.empty())
+        {
+            std::cout << "Part 1:" << std::endl;
+            std::cout << answers.part1 << std::endl;
+        }
+
+        if (!answers.part2.empty())
+        {
+            std::cout << "Part 2:" << std::endl;
+            std::cout << answers.part2 << std::endl;
+        }
+    }
+
+    int RunExercise(ExerciseSolver& solver)
+    {
+        ADVENT_OF_CODE_PHASE_TIMER(readTimer, solver.GetName(), "read");
+        const MappedTextFile lines(solver.GetInputFilename());
+        ADVENT_OF_CODE_STOP_TIMER(readTimer);
+        if (!lines.IsOpen())
+        {
+            std::cerr << "Unable to open " << solver.GetInputFilename() << std::endl;
+            return 1;
+        }
+
+        ADVENT_OF_CODE_PHASE_TIMER(parseTimer, solver.GetName(), "parse");
+        solver.Parse(lines);
+        ADVENT_OF_CODE_STOP_TIMER(parseTimer);
+
+        ADVENT_OF_CODE_PHASE_TIMER(solveTimer, solver.GetName(), "solve");
+        const auto answers = solver.Solve();
+        ADVENT_OF_CODE_STOP_TIMER(solveTimer);
+
+        PrintAnswers(answers);
+        return 0;
+    }
+
+    int RunExercise(StreamingExerciseSolver& solver, int argc, char** argv)
+    {
+        if (argc < 2 || strcmp(argv[1], "--stdin") != 0)
+            return RunExercise(solver);
+
+        // Reading, parsing and solving are interleaved, so they can only be timed together
+        ADVENT_OF_CODE_PHASE_TIMER(streamTimer, solver.GetName(), "stream");
+        StreamingLineReader reader(STDIN_FILENO);
+        const auto answers = solver.SolveStreaming(reader);
+        ADVENT_OF_CODE_STOP_TIMER(streamTimer);
+
+        PrintAnswers(answers);
+        return 0;
+    }
+}
+
+#ifdef ADVENT_OF_CODE_TRACK_ALLOCATIONS
+// The replacements have to live in the global namespace. Everything, including the nothrow and
+// aligned forms, goes through the same counter.
+//
+// GCC can't tell that these operator new replacements use malloc, so it warns about every free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+    void* memory = AdventOfCodeUtils::TrackedAllocate(size, alignof(std::max_align_t));
+    if (!memory)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    void* memory = AdventOfCodeUtils::TrackedAllocate(size, static_cast<size_t>(alignment));
+    if (!memory)
+        throw std::bad_alloc();
+
+    return memory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return AdventOfCodeUtils::TrackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return AdventOfCodeUtils::TrackedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AdventOfCodeUtils::TrackedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AdventOfCodeUtils::TrackedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
@@ -1,10 +1,459 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-using namespace std;
+#ifdef ADVENT_OF_CODE_ZLIB
+#include <zlib.h>
+#endif
 
 namespace AdventOfCodeUtils
 {
-    vector<string> ReadTextFile(string filename);
-}
\ No newline at end of file
+    // Read-only memory mapping of a whole file, for inputs that aren't text
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string& filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool IsOpen() const
+        {
+            return m_isOpen;
+        }
+
+        // nullptr for an empty file
+        const char* GetData() const
+        {
+            return m_data;
+        }
+
+        size_t GetSize() const
+        {
+            return m_size;
+        }
+
+    private:
+        const char* m_data;
+        size_t m_size;
+        bool m_isOpen;
+    };
+
+    // Read-only view of a text file. The file is memory mapped and the line boundaries are
+    // indexed once up front, so each line is a string_view into the mapping instead of its
+    // own heap allocated string. Lines are only valid while the MappedTextFile is alive.
+    //
+    // Lines are split the same way std::getline splits them: a trailing newline at the end
+    // of the file does not produce an extra empty line.
+    class MappedTextFile
+    {
+    public:
+        MappedTextFile(const std::string& filename);
+        ~MappedTextFile();
+
+        MappedTextFile(const MappedTextFile&) = delete;
+        MappedTextFile& operator=(const MappedTextFile&) = delete;
+
+        bool IsOpen() const
+        {
+            return m_file.IsOpen();
+        }
+
+        std::string_view GetContents() const
+        {
+            return std::string_view(m_file.GetData(), m_file.GetSize());
+        }
+
+        // Container-style access so the exercises can treat the file as a list of lines
+        size_t size() const
+        {
+            return m_lines.size();
+        }
+
+        bool empty() const
+        {
+            return m_lines.empty();
+        }
+
+        std::string_view operator[](const size_t lineNumber) const
+        {
+            return m_lines[lineNumber];
+        }
+
+        std::vector<std::string_view>::const_iterator begin() const
+        {
+            return m_lines.begin();
+        }
+
+        std::vector<std::string_view>::const_iterator end() const
+        {
+            return m_lines.end();
+        }
+
+    private:
+        void IndexLines();
+
+        const MappedFile m_file;
+        std::vector<std::string_view> m_lines;
+    };
+
+    // Reads lines from a file descriptor (stdin by default) through a fixed size buffer, so the
+    // input can be processed while it is still arriving and memory use doesn't depend on how
+    // long the input is. A line is only valid until the next call to NextLine. The buffer only
+    // grows when a single line doesn't fit in it.
+    //
+    // Lines are split the same way as MappedTextFile splits them.
+    class StreamingLineReader
+    {
+    public:
+        StreamingLineReader(const int fd = 0, const size_t bufferSize = 64 * 1024);
+        ~StreamingLineReader() = default;
+
+        StreamingLineReader(const StreamingLineReader&) = delete;
+        StreamingLineReader& operator=(const StreamingLineReader&) = delete;
+
+        bool NextLine(std::string_view& line /* out */);
+
+        // Hands out the rest of the input as it arrives, in whatever pieces it arrives in and
+        // newlines included, starting after the last line returned by NextLine. The bytes are
+        // only valid until the next call.
+        bool NextBytes(std::string_view& bytes /* out */);
+
+    private:
+        bool Refill();
+
+        const int m_fd;
+        std::vector<char> m_buffer;
+        size_t m_lineStart;
+        size_t m_searchStart;
+        size_t m_end;
+        bool m_endOfInput;
+    };
+
+#ifdef ADVENT_OF_CODE_ZLIB
+    // Decompresses a gzip file on a thread of its own into a ring of buffers, so the reader
+    // works on one buffer while the next ones are being filled and nothing is written to disk.
+    // Files that aren't compressed are read as they are. Only built with ADVENT_OF_CODE_ZLIB
+    // defined, and needs linking with -lz.
+    class DecompressingReader
+    {
+    public:
+        DecompressingReader(const std::string& filename, const size_t numBuffers = 4, const size_t bufferSize = 256 * 1024);
+        ~DecompressingReader();
+
+        DecompressingReader(const DecompressingReader&) = delete;
+        DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+        bool IsOpen() const
+        {
+            return m_file != nullptr;
+        }
+
+        // Same as StreamingLineReader::NextBytes, the bytes are only valid until the next call.
+        // Returns false at the end of the data, or when the file turns out to be corrupt.
+        bool NextBytes(std::string_view& bytes /* out */);
+
+        // True if decompressing stopped because the file is corrupt or truncated
+        bool HasFailed() const;
+
+    private:
+        void Decompress();
+
+        gzFile m_file;
+        std::vector<std::vector<char> > m_buffers;
+        std::vector<size_t> m_bufferSizes;
+
+        // Buffer n of the data goes in m_buffers[n % m_buffers.size()]. The reader holds on to
+        // the buffer it was handed last until it asks for the next one. All guarded by m_mutex.
+        mutable std::mutex m_mutex;
+        std::condition_variable m_bufferFilled;
+        std::condition_variable m_bufferFreed;
+        size_t m_numFilled;
+        size_t m_numConsumed;
+        bool m_holdingBuffer;
+        bool m_finished;
+        bool m_failed;
+        bool m_stopping;
+
+        std::thread m_decompressor;
+    };
+#endif
+
+    // Returns the index of the first delimiter at or after position, or npos if there isn't one.
+    // Scans 16 bytes at a time where SSE2 is available.
+    size_t FindDelimiter(std::string_view input, size_t position, const char delimiter);
+
+    // Splits a string_view on a single character without allocating. Tokens are views into the
+    // source buffer and follow the same rules as std::getline: consecutive delimiters produce
+    // empty tokens but a trailing delimiter does not.
+    class Tokenizer
+    {
+    public:
+        Tokenizer(std::string_view input, const char delimiter = ' ')
+            : m_input(input)
+            , m_position(0)
+            , m_delimiter(delimiter)
+        {}
+
+        ~Tokenizer() = default;
+
+        bool Next(std::string_view& token /* out */)
+        {
+            if (m_position >= m_input.size())
+                return false;
+
+            auto tokenEnd = FindDelimiter(m_input, m_position, m_delimiter);
+            if (tokenEnd == std::string_view::npos)
+                tokenEnd = m_input.size();
+
+            token = m_input.substr(m_position, tokenEnd - m_position);
+            m_position = tokenEnd + 1;
+            return true;
+        }
+
+    private:
+        std::string_view m_input;
+        size_t m_position;
+        const char m_delimiter;
+    };
+
+    // Fills tokens with the views produced by a Tokenizer and returns how many there were.
+    // Callers keep the vector around between lines so its storage is reused.
+    size_t SplitInto(std::string_view input, const char delimiter, std::vector<std::string_view>& tokens /* out */);
+
+    // Hands out memory straight from mmap, rounded up to whole 2MiB huge pages, and asks the
+    // kernel to back it with transparent huge pages. Only meant as the upstream of an arena,
+    // since every allocation is at least one huge page.
+    class HugePageMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        HugePageMemoryResource() = default;
+        ~HugePageMemoryResource() = default;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* memory, size_t bytes, size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // Monotonic arena for the node-heavy data structures. Creating a node is a pointer bump and
+    // all of them are freed at once when the arena is reset or destroyed. Destructors of the
+    // objects in the arena are never run, so they must only own memory that also comes from
+    // the arena (pmr containers built on GetResource, strings from CopyString).
+    //
+    // Huge page backing is off unless ADVENT_OF_CODE_HUGE_PAGES is defined.
+    class NodeArena
+    {
+    public:
+#ifdef ADVENT_OF_CODE_HUGE_PAGES
+        NodeArena(const bool useHugePages = true);
+#else
+        NodeArena(const bool useHugePages = false);
+#endif
+        ~NodeArena() = default;
+
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        template <typename T, typename... Args>
+        T* Create(Args&&... args)
+        {
+            void* memory = m_resource.allocate(sizeof(T), alignof(T));
+            return new (memory) T(std::forward<Args>(args)...);
+        }
+
+        std::string_view CopyString(std::string_view str);
+
+        std::pmr::memory_resource* GetResource()
+        {
+            return &m_resource;
+        }
+
+        // Frees everything created so far, none of it may be used afterwards
+        void Reset()
+        {
+            m_resource.release();
+        }
+
+    private:
+        HugePageMemoryResource m_hugePages;
+        std::pmr::monotonic_buffer_resource m_resource;
+    };
+
+    // Fixed set of worker threads, each with its own deque of tasks. A worker runs the newest
+    // task from its own deque first and steals the oldest task from another worker when its own
+    // deque is empty. Tasks submitted from inside a task go to the current worker's deque, so a
+    // continuation usually runs on the same thread as the task that submitted it.
+    class ThreadPool
+    {
+    public:
+        typedef std::function<void()> Task;
+
+        ThreadPool(const size_t numThreads = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void Submit(Task task);
+
+        // Blocks until every submitted task has finished, including tasks submitted by other
+        // tasks in the meantime. Must not be called from inside a task.
+        void Wait();
+
+        size_t GetNumThreads() const
+        {
+            return m_threads.size();
+        }
+
+    private:
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void WorkerLoop(const size_t workerIndex);
+        bool TryPop(const size_t workerIndex, Task& task /* out */);
+
+        std::vector<std::unique_ptr<WorkerQueue> > m_queues;
+        std::vector<std::thread> m_threads;
+        std::atomic<size_t> m_nextQueue;
+
+        // Counts of tasks that are queued but not claimed by a worker yet, and of tasks that
+        // haven't finished yet. Both are guarded by m_mutex.
+        std::mutex m_mutex;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_allDone;
+        size_t m_unclaimedTasks;
+        size_t m_unfinishedTasks;
+        bool m_stopping;
+    };
+
+    // Parses a string made up of nothing but base 10 digits, without allocating or looking at
+    // the locale. Runs of 8 digits are converted at once with SWAR arithmetic on a 64 bit word.
+    // Returns false for an empty string, any other character, or more than 19 significant
+    // digits (the most that always fit in a uint64_t).
+    bool ParseDigits(std::string_view digits, uint64_t& value /* out */);
+
+    // Replacement for std::stoi and friends. Parses the whole string as an integer with an
+    // optional leading '-' (only for signed types). Returns false instead of throwing when the
+    // string isn't a number or the number doesn't fit in T, value is left untouched then.
+    template <typename T>
+    bool ParseInteger(std::string_view str, T& value /* out */)
+    {
+        static_assert(std::is_integral<T>::value, "ParseInteger only parses integers");
+
+        const bool negative = !str.empty() && str.front() == '-';
+        if (negative)
+        {
+            if (!std::is_signed<T>::value)
+                return false;
+
+            str.remove_prefix(1);
+        }
+
+        uint64_t magnitude;
+        if (!ParseDigits(str, magnitude))
+            return false;
+
+        const auto maxMagnitude = static_cast<uint64_t>(std::numeric_limits<T>::max());
+        if (negative)
+        {
+            // Two's complement has room for one more negative value than positive
+            if (magnitude > maxMagnitude + 1)
+                return false;
+
+            value = static_cast<T>(~magnitude + 1);
+        }
+        else
+        {
+            if (magnitude > maxMagnitude)
+                return false;
+
+            value = static_cast<T>(magnitude);
+        }
+
+        return true;
+    }
+
+    // Quotes and escapes a string so it can be written out as a JSON string value
+    std::string EscapeJsonString(std::string_view input);
+
+    struct AllocationStatistics
+    {
+        uint64_t count;
+        uint64_t bytes;
+    };
+
+    // Building with ADVENT_OF_CODE_TRACK_ALLOCATIONS replaces the global operator new and
+    // delete with versions that count every allocation made by each thread. Without it these
+    // counts are always zero.
+    bool IsAllocationTrackingEnabled();
+
+    // Allocations made by the calling thread since it started. Take the difference of two
+    // calls to get the allocations made by the code in between.
+    AllocationStatistics GetThreadAllocations();
+
+    // The most memory the process has had resident at any point so far
+    uint64_t GetPeakResidentBytes();
+
+    struct Answers
+    {
+        std::string part1;
+        std::string part2;
+    };
+
+    // Every exercise is a solver with a separate parse and solve step, so the same code can be
+    // driven by the exercise's own main() or by the benchmark. The file handed to Parse must
+    // outlive the calls to Solve, and Solve may be called repeatedly on the same parsed input.
+    class ExerciseSolver
+    {
+    public:
+        ExerciseSolver() = default;
+        virtual ~ExerciseSolver() = default;
+
+        virtual const char* GetName() const = 0;
+        virtual const char* GetInputFilename() const = 0;
+
+        virtual void Parse(const MappedTextFile& lines) = 0;
+        virtual Answers Solve() const = 0;
+    };
+
+    // Exercises that only need a single pass over their input can also be solved straight from
+    // a StreamingLineReader, without the input ever being held in memory as a whole
+    class StreamingExerciseSolver : public ExerciseSolver
+    {
+    public:
+        StreamingExerciseSolver() = default;
+        virtual ~StreamingExerciseSolver() = default;
+
+        virtual Answers SolveStreaming(StreamingLineReader& reader) const = 0;
+    };
+
+    // Reads the solver's input from the working directory, solves it and prints the answers
+    int RunExercise(ExerciseSolver& solver);
+
+    // Same as above, but reads the input from stdin as it arrives when --stdin is passed
+    int RunExercise(StreamingExerciseSolver& solver, int argc, char** argv);
+}
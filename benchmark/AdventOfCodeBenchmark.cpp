@@ -0,0 +1,313 @@
+// Times the read, parse and solve phases of every exercise and writes the results as JSON.
+//
+// Build from the repository root with the exercises linked in as a library:
+//   g++ -std=c++17 -O2 -DADVENT_OF_CODE_NO_MAIN -o aoc_benchmark benchmark/AdventOfCodeBenchmark.cpp
+//       AdventOfCodeExercises.cpp AdventOfCodeUtils.cpp exercise*/AdventOfCodeExercise*.cpp
+//
+// Usage:
+//   aoc_benchmark [--warmup N] [--repetitions N] [--output results.json] [--input-root DIR]
+//                 [--only exercise7] [--input exercise7=path/to/input.txt]
+//
+// Also build with -DADVENT_OF_CODE_TRACK_ALLOCATIONS to report how many allocations each phase
+// makes next to its timings.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeExercises.h"
+#include "../AdventOfCodeInstrumentation.h"
+
+namespace
+{
+
+struct BenchmarkOptions
+{
+    uint32_t warmup = 1;
+    uint32_t repetitions = 10;
+    std::string outputFilename = "benchmark_results.json";
+    std::string inputRoot = ".";
+    std::vector<std::string> only;
+    std::map<std::string, std::string> inputOverrides;
+};
+
+struct PhaseStatistics
+{
+    uint64_t minNs;
+    uint64_t medianNs;
+    uint64_t p99Ns;
+    uint64_t meanNs;
+};
+
+struct ExerciseResult
+{
+    std::string name;
+    std::string inputFilename;
+    uint64_t inputBytes = 0;
+    AdventOfCodeUtils::Answers answers;
+    std::vector<std::pair<std::string, PhaseStatistics> > phases;
+
+    // Every run allocates the same, so these come from the last run. The peak RSS is for the
+    // whole process, so it includes the exercises benchmarked before this one.
+    std::vector<AdventOfCodeUtils::AllocationStatistics> phaseAllocations;
+    uint64_t peakResidentBytes = 0;
+};
+
+const char* const phaseNames[] = { "read", "parse", "solve", "total" };
+const size_t numPhases = sizeof(phaseNames) / sizeof(phaseNames[0]);
+
+uint64_t ElapsedNs(const std::chrono::steady_clock::time_point start)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+AdventOfCodeUtils::AllocationStatistics AllocationsSince(const AdventOfCodeUtils::AllocationStatistics& start)
+{
+    const auto now = AdventOfCodeUtils::GetThreadAllocations();
+    return { now.count - start.count, now.bytes - start.bytes };
+}
+
+PhaseStatistics ComputeStatistics(std::vector<uint64_t> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    // Nearest-rank percentiles
+    const auto percentile = [&samples](const double p)
+    {
+        const auto rank = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+        return samples[std::min(rank, samples.size() - 1)];
+    };
+
+    uint64_t total = 0;
+    for (const auto sample : samples)
+    {
+        total += sample;
+    }
+
+    return { samples.front(), percentile(0.5), percentile(0.99), total / samples.size() };
+}
+
+bool ParseOptions(int argc, char** argv, BenchmarkOptions& options /* out */)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--warmup" && hasValue)
+        {
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], options.warmup))
+                return false;
+        }
+        else if (argument == "--repetitions" && hasValue)
+        {
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], options.repetitions))
+                return false;
+
+            options.repetitions = std::max(1u, options.repetitions);
+        }
+        else if (argument == "--output" && hasValue)
+        {
+            options.outputFilename = argv[++i];
+        }
+        else if (argument == "--input-root" && hasValue)
+        {
+            options.inputRoot = argv[++i];
+        }
+        else if (argument == "--only" && hasValue)
+        {
+            options.only.push_back(argv[++i]);
+        }
+        else if (argument == "--input" && hasValue)
+        {
+            // exercise7=path/to/input.txt
+            const std::string value(argv[++i]);
+            const auto separator = value.find('=');
+            if (separator == std::string::npos)
+                return false;
+
+            options.inputOverrides[value.substr(0, separator)] = value.substr(separator + 1);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool RunExerciseBenchmark(
+    const AdventOfCodeExercises::ExerciseEntry& exercise,
+    const BenchmarkOptions& options,
+    ExerciseResult& result /* out */)
+{
+    const auto prototype = exercise.create();
+    result.name = prototype->GetName();
+
+    const auto inputOverride = options.inputOverrides.find(result.name);
+    result.inputFilename = inputOverride != options.inputOverrides.end()
+        ? inputOverride->second
+        : options.inputRoot + "/" + exercise.directory + "/" + prototype->GetInputFilename();
+
+    std::vector<std::vector<uint64_t> > samples(numPhases);
+    result.phaseAllocations.resize(numPhases);
+    const auto totalRuns = options.warmup + options.repetitions;
+    for (uint32_t run = 0; run < totalRuns; ++run)
+    {
+        // Every run starts from a fresh solver so the parse phase does all of its work again
+        const auto solver = exercise.create();
+
+        ADVENT_OF_CODE_PHASE_TIMER(readTimer, result.name, "read");
+        const auto readAllocationsStart = AdventOfCodeUtils::GetThreadAllocations();
+        const auto readStart = std::chrono::steady_clock::now();
+        const AdventOfCodeUtils::MappedTextFile lines(result.inputFilename);
+        const auto readNs = ElapsedNs(readStart);
+        const auto readAllocations = AllocationsSince(readAllocationsStart);
+        ADVENT_OF_CODE_STOP_TIMER(readTimer);
+        if (!lines.IsOpen())
+        {
+            std::cerr << "Unable to open " << result.inputFilename << std::endl;
+            return false;
+        }
+
+        result.inputBytes = lines.GetContents().size();
+
+        ADVENT_OF_CODE_PHASE_TIMER(parseTimer, result.name, "parse");
+        const auto parseAllocationsStart = AdventOfCodeUtils::GetThreadAllocations();
+        const auto parseStart = std::chrono::steady_clock::now();
+        solver->Parse(lines);
+        const auto parseNs = ElapsedNs(parseStart);
+        const auto parseAllocations = AllocationsSince(parseAllocationsStart);
+        ADVENT_OF_CODE_STOP_TIMER(parseTimer);
+
+        ADVENT_OF_CODE_PHASE_TIMER(solveTimer, result.name, "solve");
+        const auto solveAllocationsStart = AdventOfCodeUtils::GetThreadAllocations();
+        const auto solveStart = std::chrono::steady_clock::now();
+        result.answers = solver->Solve();
+        const auto solveNs = ElapsedNs(solveStart);
+        const auto solveAllocations = AllocationsSince(solveAllocationsStart);
+        ADVENT_OF_CODE_STOP_TIMER(solveTimer);
+
+        if (run < options.warmup)
+            continue;
+
+        samples[0].push_back(readNs);
+        samples[1].push_back(parseNs);
+        samples[2].push_back(solveNs);
+        samples[3].push_back(readNs + parseNs + solveNs);
+
+        result.phaseAllocations[0] = readAllocations;
+        result.phaseAllocations[1] = parseAllocations;
+        result.phaseAllocations[2] = solveAllocations;
+        result.phaseAllocations[3] = {
+            readAllocations.count + parseAllocations.count + solveAllocations.count,
+            readAllocations.bytes + parseAllocations.bytes + solveAllocations.bytes };
+    }
+
+    result.peakResidentBytes = AdventOfCodeUtils::GetPeakResidentBytes();
+
+    for (size_t phase = 0; phase < numPhases; ++phase)
+    {
+        result.phases.push_back(std::make_pair(phaseNames[phase], ComputeStatistics(samples[phase])));
+    }
+
+    return true;
+}
+
+void WriteResults(const BenchmarkOptions& options, const std::vector<ExerciseResult>& results)
+{
+    std::ofstream output(options.outputFilename);
+    output << "{\n";
+    output << "  \"warmup\": " << options.warmup << ",\n";
+    output << "  \"repetitions\": " << options.repetitions << ",\n";
+    output << "  \"exercises\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        output << "    {\n";
+        output << "      \"name\": " << AdventOfCodeUtils::EscapeJsonString(result.name) << ",\n";
+        output << "      \"input\": " << AdventOfCodeUtils::EscapeJsonString(result.inputFilename) << ",\n";
+        output << "      \"input_bytes\": " << result.inputBytes << ",\n";
+        output << "      \"peak_rss_bytes\": " << result.peakResidentBytes << ",\n";
+        output << "      \"answers\": { \"part1\": " << AdventOfCodeUtils::EscapeJsonString(result.answers.part1)
+               << ", \"part2\": " << AdventOfCodeUtils::EscapeJsonString(result.answers.part2) << " },\n";
+        output << "      \"phases\": {\n";
+        for (size_t j = 0; j < result.phases.size(); ++j)
+        {
+            const auto& stats = result.phases[j].second;
+            output << "        " << AdventOfCodeUtils::EscapeJsonString(result.phases[j].first)
+                   << ": { \"min_ns\": " << stats.minNs
+                   << ", \"median_ns\": " << stats.medianNs
+                   << ", \"p99_ns\": " << stats.p99Ns
+                   << ", \"mean_ns\": " << stats.meanNs;
+            if (AdventOfCodeUtils::IsAllocationTrackingEnabled())
+            {
+                output << ", \"allocations\": " << result.phaseAllocations[j].count
+                       << ", \"allocated_bytes\": " << result.phaseAllocations[j].bytes;
+            }
+            output << " }"
+                   << (j + 1 < result.phases.size() ? "," : "") << "\n";
+        }
+        output << "      }\n";
+        output << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    output << "  ]\n";
+    output << "}\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--warmup N] [--repetitions N] [--output FILE] [--input-root DIR]"
+                  << " [--only NAME] [--input NAME=FILE]" << std::endl;
+        return 1;
+    }
+
+    std::vector<ExerciseResult> results;
+    for (const auto& exercise : AdventOfCodeExercises::GetExercises())
+    {
+        if (!options.only.empty() &&
+            std::find(options.only.begin(), options.only.end(), exercise.directory) == options.only.end())
+        {
+            continue;
+        }
+
+        ExerciseResult result;
+        if (!RunExerciseBenchmark(exercise, options, result))
+            return 1;
+
+        std::cout << result.name << std::endl;
+        for (size_t i = 0; i < result.phases.size(); ++i)
+        {
+            const auto& phase = result.phases[i];
+            std::cout << "  " << phase.first
+                      << "  min " << phase.second.minNs / 1000.0 << "us"
+                      << "  median " << phase.second.medianNs / 1000.0 << "us"
+                      << "  p99 " << phase.second.p99Ns / 1000.0 << "us";
+            if (AdventOfCodeUtils::IsAllocationTrackingEnabled())
+            {
+                std::cout << "  allocations " << result.phaseAllocations[i].count
+                          << " (" << result.phaseAllocations[i].bytes << " bytes)";
+            }
+            std::cout << std::endl;
+        }
+
+        std::cout << "  peak rss " << result.peakResidentBytes / 1024 << "KiB" << std::endl;
+
+        results.push_back(result);
+    }
+
+    WriteResults(options, results);
+    return 0;
+}
@@ -1,44 +1,18 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <algorithm>
+#include <assert.h>
 #include <stdint.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise10
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
 class Instruction
 {
 public:
@@ -107,10 +81,11 @@ public:
     }
     ~InstructionProcessor() = default;
 
-    std::shared_ptr<Instruction> ProcessInstruction(const std::string& instruction)
+    std::shared_ptr<Instruction> ProcessInstruction(std::string_view instruction)
     {
-        const auto strings = Split(instruction, ' ');
-        const auto& instructionType = strings[0];
+        AdventOfCodeUtils::Tokenizer tokenizer(instruction);
+        std::string_view instructionType;
+        tokenizer.Next(instructionType);
 
         if (instructionType == "noop")
         {
@@ -118,8 +93,12 @@ public:
         }
         else if (instructionType == "addx")
         {
-            assert(strings.size() == 2);
-            const auto input = std::stoi(strings[1]);
+            std::string_view inputStr;
+            const auto hasInput = tokenizer.Next(inputStr);
+            assert(hasInput);
+            int input = 0;
+            const auto parsed = AdventOfCodeUtils::ParseInteger(inputStr, input);
+            assert(parsed);
             m_currentInstruction = std::make_shared<AddX>(input);
         }
 
@@ -148,86 +127,176 @@ private:
 
 // TODO: looks like the last line of pixels isn't quite right, but I
 // can still read the answer for 2.
-void AdventOfCodeExercise10()
+// Collects the image, unless it is given a stream for it, in which case every row goes to the
+// stream as soon as it is complete and only the current one is kept
+class CathodeRayTube
 {
-    const auto lines = ReadTextFile("input_exercise_10.txt");
-    int interestingCyclesCurrent = 20;
-    const int interestingCyclesIncrement = 40;
-    const int interestingCyclesEnd = 220;
-
-    const auto lightPixel = "#";
-    const auto darkPixel = ".";
-    const auto spriteLength = 3;
-    std::unordered_map<int, int> signalStrengths;
+public:
+    CathodeRayTube(std::ostream* completedRows = nullptr)
+        : m_cycle(0)
+        , m_instructionCycleCount(0)
+        , m_interestingCyclesCurrent(20)
+        , m_totalSignalStrength(0)
+        , m_completedRows(completedRows)
+    {}
+
+    ~CathodeRayTube() = default;
+
+    // Runs a single cycle of the given instruction. Returns true once the instruction has
+    // finished, i.e. when the caller should move on to the next one.
+    bool Step(std::string_view instruction)
+    {
+        const int interestingCyclesIncrement = 40;
+        const auto lightPixel = '#';
+        const auto darkPixel = '.';
 
-    InstructionProcessor processor;
-    uint32_t cycle = 0;
-    auto lineItr = lines.begin();
-    uint32_t instructionCycleCount = 0;
+        bool instructionFinished = false;
 
-    while (true)
-    {
         // TODO: this can be made more efficient, but it's probably not trivial
-        const auto& instructionType = processor.ProcessInstruction(*lineItr);
+        const auto& instructionType = m_processor.ProcessInstruction(instruction);
         if (instructionType->IsNoop())
         {
-            lineItr++;
+            instructionFinished = true;
         }
         else if (instructionType->IsAddX())
         {
-            if (instructionCycleCount == 2)
+            if (m_instructionCycleCount == 2)
             {   
-                processor.ExecuteCurrentInstruction();
-                instructionCycleCount = 0;
-                lineItr++;
+                m_processor.ExecuteCurrentInstruction();
+                m_instructionCycleCount = 0;
+                instructionFinished = true;
             }
 
-            instructionCycleCount++;
+            m_instructionCycleCount++;
         }
 
-        const auto currentRegisterValue = processor.GetCurrentRegisterValue();
+        const auto currentRegisterValue = m_processor.GetCurrentRegisterValue();
         std::vector<int> spritePosition(3);
         spritePosition.push_back(currentRegisterValue);
         spritePosition.push_back(currentRegisterValue + 1);
         spritePosition.push_back(currentRegisterValue + 2);
     
-        cycle++;
-        const auto normalizedCycleNumber = cycle % 40;
-        auto stringToUse =
+        m_cycle++;
+        ADVENT_OF_CODE_COUNT("exercise10.cycles");
+        const auto normalizedCycleNumber = m_cycle % 40;
+        const auto pixel =
             std::find(spritePosition.begin(), spritePosition.end(), normalizedCycleNumber) != spritePosition.end()
                 ? lightPixel
                 : darkPixel;
         
-        std::cout << stringToUse;     
+        m_image.push_back(pixel);
 
         if (normalizedCycleNumber == 0)
-            std::cout << std::endl;
-
+        {
+            m_image.push_back('\n');
+            if (m_completedRows)
+            {
+                *m_completedRows << m_image;
+                m_image.clear();
+            }
+        }
 
-        if (cycle == interestingCyclesCurrent)
+        if (m_cycle == m_interestingCyclesCurrent)
         {
-            signalStrengths[cycle] = cycle * processor.GetCurrentRegisterValue();
-            interestingCyclesCurrent += interestingCyclesIncrement;
+            m_totalSignalStrength += static_cast<int64_t>(m_cycle) * m_processor.GetCurrentRegisterValue();
+            m_interestingCyclesCurrent += interestingCyclesIncrement;
         }
 
-        if (lineItr == lines.end())
+        return instructionFinished;
+    }
+
+    int64_t GetTotalSignalStrength() const
+    {
+        return m_totalSignalStrength;
+    }
+
+    // Only the row that isn't complete yet when the rows go to a stream
+    const std::string& GetImage() const
+    {
+        return m_image;
+    }
+
+private:
+    InstructionProcessor m_processor;
+    uint32_t m_cycle;
+    uint32_t m_instructionCycleCount;
+    uint32_t m_interestingCyclesCurrent;
+    int64_t m_totalSignalStrength;
+    std::ostream* m_completedRows;
+    std::string m_image;
+};
+
+class Solver : public AdventOfCodeUtils::StreamingExerciseSolver
+{
+public:
+    Solver()
+        : m_lines(nullptr) {}
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise10";
+    }
+
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_10.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        // Instructions are decoded as the CRT executes them, so there is next to nothing to time
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise10.build");
+        m_lines = &lines;
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        CathodeRayTube crt;
+        for (const auto& line : *m_lines)
         {
-            break;
+            while (!crt.Step(line))
+            {
+            }
         }
+
+        return { std::to_string(crt.GetTotalSignalStrength()), crt.GetImage() };
     }
 
-    int totalPart1 = 0;
-    
-    std::cout << std::endl;
-    for (const auto& signal : signalStrengths)
+    // The image grows with the input, so its rows are printed as soon as they are complete
+    // instead of being returned. That puts part 2 ahead of part 1, which is only known at the end.
+    AdventOfCodeUtils::Answers SolveStreaming(AdventOfCodeUtils::StreamingLineReader& reader) const override
     {
-        totalPart1 += signal.second;
+        std::cout << "Part 2:" << std::endl;
+        CathodeRayTube crt(&std::cout);
+        std::string_view line;
+        while (reader.NextLine(line))
+        {
+            while (!crt.Step(line))
+            {
+            }
+        }
+
+        if (!crt.GetImage().empty())
+            std::cout << crt.GetImage() << '\n';
+
+        return { std::to_string(crt.GetTotalSignalStrength()), "" };
     }
 
-    std::cout << totalPart1 << std::endl;
+private:
+    const AdventOfCodeUtils::MappedTextFile* m_lines;
+};
 }
 
-int main()
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise10Solver()
 {
-    AdventOfCodeExercise10();
-}
\ No newline at end of file
+    return std::make_unique<Exercise10::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
+int main(int argc, char** argv)
+{
+    Exercise10::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver, argc, argv);
+}
+#endif
@@ -1,49 +1,24 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 #include <string>
+#include <string_view>
 #include <queue>
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
-
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+#include <memory>
+#include <numeric>
+#include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
+
+namespace Exercise11
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter = ' ')
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
-std::string Trim(const std::string& str,
-                 const std::string& whitespace = " \t")
+std::string_view Trim(std::string_view str,
+                      std::string_view whitespace = " \t")
 {
     const auto strBegin = str.find_first_not_of(whitespace);
-    if (strBegin == std::string::npos)
+    if (strBegin == std::string_view::npos)
         return ""; // no content
 
     const auto strEnd = str.find_last_not_of(whitespace);
@@ -104,9 +79,12 @@ long long int multiplication(const long long int a, const long long int b)
     return a * b;
 }
 
-std::function<long long int(long long int, long long int)> ParseBinaryOperation(const std::string& op)
+// A plain function pointer rather than a std::function, so the nodes stay trivial to free
+typedef long long int (*BinaryOperation)(const long long int, const long long int);
+
+BinaryOperation ParseBinaryOperation(std::string_view op)
 {
-    std::function<long long int(long long int, long long int)> opFn;
+    BinaryOperation opFn = nullptr;
     if (op == "+")
     {
         opFn = addition;
@@ -123,13 +101,14 @@ std::function<long long int(long long int, long long int)> ParseBinaryOperation(
     return opFn;
 }
 
+// The nodes live in the solver's arena and are freed all at once with it
 class BinaryOpNode : public ExpressionNode
 {
 public:
     BinaryOpNode(
-        std::shared_ptr<ExpressionNode> rhs,
-        std::shared_ptr<ExpressionNode> lhs,
-        const std::string& op)
+        const ExpressionNode* rhs,
+        const ExpressionNode* lhs,
+        std::string_view op)
             : m_rhs(rhs)
             , m_lhs(lhs)
         {
@@ -141,31 +120,31 @@ public:
         return v.VisitBinaryOp(*this);
     }
 
-    std::shared_ptr<ExpressionNode> GetRHS() const
+    const ExpressionNode* GetRHS() const
     {
         return m_rhs;
     }
 
-    std::shared_ptr<ExpressionNode> GetLHS() const
+    const ExpressionNode* GetLHS() const
     {
         return m_lhs;
     }
 
-    const std::function<long long int(long long int, long long int)>& GetOp() const
+    BinaryOperation GetOp() const
     {
         return m_op;
     }
 
 private:
-    std::shared_ptr<ExpressionNode> m_rhs;
-    std::shared_ptr<ExpressionNode> m_lhs;
-    std::function<long long int(long long int, long long int)> m_op;
+    const ExpressionNode* m_rhs;
+    const ExpressionNode* m_lhs;
+    BinaryOperation m_op;
 };
 
 class VariableNode : public ExpressionNode
 {
 public:
-    VariableNode(const std::string& name)
+    VariableNode(std::string_view name)
         : m_name(name){}
     ~VariableNode() = default;
 
@@ -174,13 +153,14 @@ public:
         return v.VisitVariable(*this);
     }
 
-    const std::string& GetName() const
+    std::string_view GetName() const
     {
         return m_name;
     }
 
 private:
-    const std::string m_name;
+    // A view into the input file
+    const std::string_view m_name;
 };
 
 class ConstantNode : public ExpressionNode
@@ -208,13 +188,13 @@ class MonkeyExpressionEvaluator : public ExpressionVisitor
 {
 public:
     MonkeyExpressionEvaluator(
-        std::shared_ptr<ExpressionNode> root)
+        const ExpressionNode* root)
             : m_root(root)
         {}
 
     ~MonkeyExpressionEvaluator() = default;
 
-    const long long int Eval(const std::unordered_map<std::string, long long int> vars)
+    const long long int Eval(const std::unordered_map<std::string_view, long long int> vars)
     {
         m_vars = vars;
         return m_root->AcceptEvaluator(*this);
@@ -238,8 +218,8 @@ public:
     }
 
 private:
-    std::shared_ptr<ExpressionNode> m_root;
-    std::unordered_map<std::string, long long int> m_vars;
+    const ExpressionNode* m_root;
+    std::unordered_map<std::string_view, long long int> m_vars;
 };
 
 class MonkeyPredicate
@@ -260,7 +240,7 @@ public:
         return m_value;
     }
 
-    bool operator() (const uint32_t testValue) const
+    bool operator() (const long long int testValue) const
     {
         return testValue % m_value == 0;
     }
@@ -275,11 +255,12 @@ public:
     Monkey(
         const uint32_t number,
         const std::vector<long long int>& startingItems,
-        const std::shared_ptr<ExpressionNode> monkeyOpExpressionRoot,
+        const ExpressionNode* monkeyOpExpressionRoot,
         const MonkeyPredicate monkeyPredicate,
         const uint32_t throwToIfPredicateFalse,
         const uint32_t throwToIfPredicateTrue)
-            : m_number(number)
+            : m_inspectedObjectCount(0)
+            , m_number(number)
             , m_monkeyOpExpressionRoot(monkeyOpExpressionRoot)
             , m_monkeyPredicate(monkeyPredicate)
             , m_throwToIfPredicateFalse(throwToIfPredicateFalse)
@@ -304,7 +285,7 @@ public:
         m_items.push(itemNumber);
     }
 
-    std::shared_ptr<ExpressionNode> GetExpressionRoot() const
+    const ExpressionNode* GetExpressionRoot() const
     {
         return m_monkeyOpExpressionRoot;
     }
@@ -343,24 +324,27 @@ private:
     std::queue<long long int> m_items;
     long long int m_inspectedObjectCount;
     const uint32_t m_number;
-    const std::shared_ptr<ExpressionNode> m_monkeyOpExpressionRoot;
+    const ExpressionNode* const m_monkeyOpExpressionRoot;
     const MonkeyPredicate m_monkeyPredicate;
     const uint32_t m_throwToIfPredicateFalse;
     const uint32_t m_throwToIfPredicateTrue;
     uint32_t m_factor;
 };
 
-std::vector<Monkey> ParseMonkeys()
+std::vector<Monkey> ParseMonkeys(const AdventOfCodeUtils::MappedTextFile& lines, AdventOfCodeUtils::NodeArena& arena)
 {
-const auto lines = ReadTextFile("input_exercise_11.txt");
+    ADVENT_OF_CODE_SCOPED_TIMER("exercise11.build");
     std::vector<Monkey> monkeys;
 
     uint32_t monkeyNumber;
     std::vector<long long int> items;
-    std::shared_ptr<ExpressionNode> monkeyOpExpressionRoot;
+    const ExpressionNode* monkeyOpExpressionRoot = nullptr;
     MonkeyPredicate monkeyPredicate;
     uint32_t throwToIfPredicateFalse;
     uint32_t throwToIfPredicateTrue;
+
+    // Reused for every line so tokenizing doesn't allocate once it has grown
+    std::vector<std::string_view> tokens;
     for (const auto& line : lines)
     {
         const auto trimmed = Trim(line);
@@ -368,24 +352,28 @@ const auto lines = ReadTextFile("input_exercise_11.txt");
         {
             // Monkey <num>:
             const auto monkeyStr = Trim(trimmed, ":");
-            const auto strings = Split(monkeyStr);
-            assert(strings.size() == 2);
+            AdventOfCodeUtils::SplitInto(monkeyStr, ' ', tokens);
+            assert(tokens.size() == 2);
 
-            monkeyNumber = std::stoi(strings[1].substr(0, 1));
+            const auto parsed = AdventOfCodeUtils::ParseInteger(tokens[1].substr(0, 1), monkeyNumber);
+            assert(parsed);
         }
         else if (trimmed.rfind(StartingItems, 0) == 0)
         {
             // Starting Items: n, m, ...
-            const auto startingItems = Split(trimmed, ':');
-            assert(startingItems.size() == 2);
-            const auto itemNumbers = Trim(startingItems[1]);
-            const auto numberStrings = Split(itemNumbers, ',');
+            AdventOfCodeUtils::SplitInto(trimmed, ':', tokens);
+            assert(tokens.size() == 2);
+            const auto itemNumbers = Trim(tokens[1]);
+            AdventOfCodeUtils::SplitInto(itemNumbers, ',', tokens);
 
             std::vector<long long int> numbers;
-            numbers.reserve(numberStrings.size());
-            for (const auto& numberStr : numberStrings)
+            numbers.reserve(tokens.size());
+            for (const auto& numberStr : tokens)
             {
-                numbers.push_back(std::stoi(Trim(numberStr)));
+                long long int number = 0;
+                const auto parsed = AdventOfCodeUtils::ParseInteger(Trim(numberStr), number);
+                assert(parsed);
+                numbers.push_back(number);
             }
 
             items = numbers;
@@ -393,17 +381,17 @@ const auto lines = ReadTextFile("input_exercise_11.txt");
         else if (trimmed.rfind(Operation, 0) == 0)
         {
             // Operation: new = old + 6
-            const auto expression = Split(trimmed, '=');
-            assert(expression.size() == 2);
-            const auto tokens = Split(Trim(expression[1]));
+            AdventOfCodeUtils::SplitInto(trimmed, '=', tokens);
+            assert(tokens.size() == 2);
+            AdventOfCodeUtils::SplitInto(Trim(tokens[1]), ' ', tokens);
 
-            std::vector<std::shared_ptr<ExpressionNode> > inputs;
-            std::string expressionFn;
+            std::vector<const ExpressionNode*> inputs;
+            std::string_view expressionFn;
             for (auto itr = tokens.begin(); itr != tokens.end(); ++itr)
             {
                 if (*itr == "old")
                 {
-                    inputs.push_back(std::make_shared<VariableNode>(*itr));
+                    inputs.push_back(arena.Create<VariableNode>(*itr));
                 }
                 else if (*itr == "+" || *itr == "*")
                 {
@@ -411,42 +399,42 @@ const auto lines = ReadTextFile("input_exercise_11.txt");
                 }
                 else
                 {
-                    try
-                    {
-                        auto val = std::stoi(*itr);
-                        inputs.push_back(std::make_shared<ConstantNode>(val));
-                    }
-                    catch (...)
-                    {
-                        assert(false);
-                    }
+                    long long int val = 0;
+                    const auto parsed = AdventOfCodeUtils::ParseInteger(*itr, val);
+                    assert(parsed);
+                    inputs.push_back(arena.Create<ConstantNode>(val));
                 }
             }
 
             assert(inputs.size() == 2);
             monkeyOpExpressionRoot = 
-                std::make_shared<BinaryOpNode>(inputs[0], inputs[1], expressionFn);
+                arena.Create<BinaryOpNode>(inputs[0], inputs[1], expressionFn);
         }
         else if (trimmed.rfind(Test, 0) == 0)
         {
             // Test: divisible by 19
-            const auto tokens = Split(trimmed, ' ');
+            AdventOfCodeUtils::SplitInto(trimmed, ' ', tokens);
             assert(tokens.size() == 4);
-            monkeyPredicate = MonkeyPredicate(std::stoi(tokens[3]));
+            uint32_t divisor = 0;
+            const auto parsed = AdventOfCodeUtils::ParseInteger(tokens[3], divisor);
+            assert(parsed);
+            monkeyPredicate = MonkeyPredicate(divisor);
         }
         else if (trimmed.rfind(IfTrue, 0) == 0)
         {
             // If true: throw to monkey 2
-            const auto tokens = Split(trimmed, ' ');
+            AdventOfCodeUtils::SplitInto(trimmed, ' ', tokens);
             assert(tokens.size() == 6);
-            throwToIfPredicateTrue = std::stoi(tokens[5]);
+            const auto parsed = AdventOfCodeUtils::ParseInteger(tokens[5], throwToIfPredicateTrue);
+            assert(parsed);
         }
         else if (trimmed.rfind(IfFalse, 0) == 0)
         {
             // If false: throw to monkey 0
-            const auto tokens = Split(trimmed, ' ');
+            AdventOfCodeUtils::SplitInto(trimmed, ' ', tokens);
             assert(tokens.size() == 6);
-            throwToIfPredicateFalse = std::stoi(tokens[5]);
+            const auto parsed = AdventOfCodeUtils::ParseInteger(tokens[5], throwToIfPredicateFalse);
+            assert(parsed);
         }
         else
         {
@@ -463,22 +451,21 @@ const auto lines = ReadTextFile("input_exercise_11.txt");
     return monkeys;
 }
 
-void AdventOfCodeExercise10()
+const long long int ComputeMonkeyBusiness(std::vector<Monkey> monkeys, const bool part1)
 {
-    auto monkeys = ParseMonkeys();
-
     // Simulation
-    bool part1 = false;
     uint32_t nRounds;
     if (part1)
         nRounds = 20;
     else
         nRounds = 10000;
 
-    uint32_t factorProduct = 1;
+    // Reducing modulo the least common multiple of the divisors keeps every test the same. A
+    // plain product wraps once enough monkeys share divisors, and stops preserving them.
+    long long int factorMultiple = 1;
     for (const auto& monkey : monkeys)
     {
-        factorProduct *= monkey.GetFactor();
+        factorMultiple = std::lcm(factorMultiple, static_cast<long long int>(monkey.GetFactor()));
     }
 
     for (int i = 0; i < nRounds; ++i)
@@ -492,14 +479,14 @@ void AdventOfCodeExercise10()
                 monkey.GetItems().pop();
                 monkey.InspectObject();
                 auto worryLevel = item;
-                std::unordered_map<std::string, long long int> vars;
+                std::unordered_map<std::string_view, long long int> vars;
                 vars["old"] = worryLevel;
 
                 worryLevel = eval.Eval(vars);
                 if (part1)
                     worryLevel /= 3;
                 else
-                    worryLevel %= factorProduct;
+                    worryLevel %= factorMultiple;
 
                 if (monkey.GetPredicate()(worryLevel))
                 {
@@ -523,12 +510,55 @@ void AdventOfCodeExercise10()
     }
     
     std::sort(itemsInspected.begin(), itemsInspected.end());
-    const long long int totalPart1 = *(itemsInspected.end() - 2) * *(itemsInspected.end() - 1);
+    return *(itemsInspected.end() - 2) * *(itemsInspected.end() - 1);
+}
 
-    std::cout << totalPart1 << std::endl;
+class Solver : public AdventOfCodeUtils::ExerciseSolver
+{
+public:
+    Solver() = default;
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise11";
+    }
+
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_11.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        m_arena.Reset();
+        m_monkeys = ParseMonkeys(lines, m_arena);
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        // The simulation moves items between monkeys, so each part works on its own copy
+        const auto totalPart1 = ComputeMonkeyBusiness(m_monkeys, true /* part1 */);
+        const auto totalPart2 = ComputeMonkeyBusiness(m_monkeys, false /* part1 */);
+
+        return { std::to_string(totalPart1), std::to_string(totalPart2) };
+    }
+
+private:
+    AdventOfCodeUtils::NodeArena m_arena;
+    std::vector<Monkey> m_monkeys;
+};
 }
 
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise11Solver()
+{
+    return std::make_unique<Exercise11::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise10();
-}
\ No newline at end of file
+    Exercise11::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
@@ -1,33 +1,19 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <unordered_map>
 #include <utility>
 #include <math.h>
+#include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise12
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile, line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
 struct pair_hash
 {
     template <class T1, class T2>
@@ -51,14 +37,14 @@ const uint32_t AlphaToHeight(const char &s)
 class Maze
 {
 public:
-    Maze(const uint32_t numRows)
+    Maze(const uint32_t numRows = 0)
     {
         m_rows.reserve(numRows);
     }
 
     ~Maze() = default;
 
-    void InsertRow(const std::string &row, const uint32_t rowNumber)
+    void InsertRow(std::string_view row, const uint32_t rowNumber)
     {
         std::vector<uint32_t> values;
 
@@ -190,6 +176,7 @@ std::unordered_map<std::pair<uint32_t, uint32_t>, uint32_t, pair_hash> BFSMaze(
     while (!nodesToExplore.empty())
     {
         const auto node = FindMinDistanceNode(nodesToExplore, distances);
+        ADVENT_OF_CODE_COUNT("exercise12.bfs_expansions");
         nodesToExplore.erase(node);
 
         if (distances.find(node) == distances.end())
@@ -219,31 +206,63 @@ std::unordered_map<std::pair<uint32_t, uint32_t>, uint32_t, pair_hash> BFSMaze(
     return distances;
 }
 
-void AdventOfCodeExercise12()
+class Solver : public AdventOfCodeUtils::ExerciseSolver
 {
-    const auto lines = ReadTextFile("input_exercise_12.txt");
-    const auto numRows = lines.size();
-    assert(lines.size() > 0);
+public:
+    Solver() = default;
+    ~Solver() = default;
 
-    const auto numCols = lines[0].size();
-    Maze maze(numRows);
-    for (auto i = 0; i < lines.size(); ++i)
+    const char* GetName() const override
     {
-        maze.InsertRow(lines[i], i);
+        return "exercise12";
     }
 
-    uint32_t minDistance = INT32_MAX;
-    for (const auto &start : maze.GetStartCandidates())
+    const char* GetInputFilename() const override
     {
-        const auto distances = BFSMaze(maze, start);
-        if (distances.find(maze.GetEnd()) != distances.end())
-            minDistance = std::min(minDistance, distances.at(maze.GetEnd()));
+        return "input_exercise_12.txt";
     }
 
-    std::cout << minDistance << std::endl;
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        const auto numRows = lines.size();
+        assert(lines.size() > 0);
+
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise12.build");
+        m_maze = Maze(numRows);
+        for (uint32_t i = 0; i < lines.size(); ++i)
+        {
+            m_maze.InsertRow(lines[i], i);
+        }
+    }
+
+    // Every 'a' is a start candidate, so this is the shortest hike from any of them (part 2)
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        uint32_t minDistance = INT32_MAX;
+        for (const auto &start : m_maze.GetStartCandidates())
+        {
+            const auto distances = BFSMaze(m_maze, start);
+            if (distances.find(m_maze.GetEnd()) != distances.end())
+                minDistance = std::min(minDistance, distances.at(m_maze.GetEnd()));
+        }
+
+        return { "", std::to_string(minDistance) };
+    }
+
+private:
+    Maze m_maze;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise12Solver()
+{
+    return std::make_unique<Exercise12::Solver>();
 }
 
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise12();
-}
\ No newline at end of file
+    Exercise12::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
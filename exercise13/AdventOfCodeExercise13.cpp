@@ -1,48 +1,23 @@
 
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
-
-std::vector<std::string> ReadTextFile(std::string inputFilename)
-{
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
+#include <memory>
+#include <algorithm>
+#include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
+
+namespace Exercise13
 {
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
-std::string Trim(const std::string& str,
-                 const std::string& whitespace = " \t")
+std::string_view Trim(std::string_view str,
+                      std::string_view whitespace = " \t")
 {
     const auto strBegin = str.find_first_not_of(whitespace);
-    if (strBegin == std::string::npos)
+    if (strBegin == std::string_view::npos)
         return ""; // no content
 
     const auto strEnd = str.find_last_not_of(whitespace);
@@ -53,32 +28,34 @@ std::string Trim(const std::string& str,
 
 class ListNode;
 
+// The nodes live in the solver's arena, so parents are plain pointers and the whole tree is
+// freed at once with the arena
 class Node
 {
 public:
-    Node(std::shared_ptr<ListNode> parent = nullptr)
+    Node(const ListNode* parent = nullptr)
         : m_parent(parent)
     {}
     virtual ~Node() {}
 
-    std::shared_ptr<ListNode> GetParent() const
+    const ListNode* GetParent() const
     {
         return m_parent;
     }
 
 private:
-    std::shared_ptr<ListNode> m_parent;
+    const ListNode* m_parent;
 };
 
 class IntegerNode : public Node
 {
 public:
-    IntegerNode(std::shared_ptr<ListNode> parent, const int v)
+    IntegerNode(const ListNode* parent, const int v)
         : Node(parent)
         , m_value(v) {}
     ~IntegerNode() = default;
 
-    const int GetValue()
+    const int GetValue() const
     {
         return m_value;
     }
@@ -90,42 +67,45 @@ private:
 class ListNode : public Node
 {
 public:
-    ListNode(std::shared_ptr<ListNode> parent)
-        : Node(parent) {}
+    ListNode(const ListNode* parent, std::pmr::memory_resource* resource)
+        : Node(parent)
+        , m_contents(resource) {}
     ~ListNode() = default;
 
-    void InsertIntegerOrList(std::shared_ptr<Node> n)
+    void InsertIntegerOrList(const Node* n)
     {
         m_contents.push_back(n);
     }
 
-    const std::vector<std::shared_ptr<Node> >& GetContents() const
+    const std::pmr::vector<const Node*>& GetContents() const
     {
         return m_contents;
     }
 
 private:
-    std::vector<std::shared_ptr<Node> > m_contents;
+    std::pmr::vector<const Node*> m_contents;
 };
 
-std::shared_ptr<IntegerNode> ParseInteger(std::shared_ptr<ListNode> parent, const std::string& integer)
+const IntegerNode* ParseInteger(const ListNode* parent, std::string_view integer, AdventOfCodeUtils::NodeArena& arena)
 {
-    const auto v = std::stoi(integer);
-    return std::make_shared<IntegerNode>(parent, v);
+    int v = 0;
+    const auto parsed = AdventOfCodeUtils::ParseInteger(integer, v);
+    assert(parsed);
+    return arena.Create<IntegerNode>(parent, v);
 }
 
-std::shared_ptr<ListNode> ParseList(std::shared_ptr<ListNode> parent, const std::string& contents)
+const ListNode* ParseList(const ListNode* parent, std::string_view contents, AdventOfCodeUtils::NodeArena& arena)
 {
     assert(contents.front() == '[');
     assert(contents.back() == ']');
-    const std::string workingString(contents.begin() + 1, contents.end() - 1);
+    const auto workingString = contents.substr(1, contents.size() - 2);
 
+    auto l = arena.Create<ListNode>(parent, arena.GetResource());
     if (workingString.empty())
     {
-        return std::make_shared<ListNode>(parent);
+        return l;
     }
 
-    auto l = std::make_shared<ListNode>(parent);
     int idx = 0;
     const auto workingStringSize = workingString.size();
     while (idx < workingStringSize)
@@ -162,7 +142,7 @@ std::shared_ptr<ListNode> ParseList(std::shared_ptr<ListNode> parent, const std:
             assert(subIdx >= idx);
 
             const auto subListStr = workingString.substr(idx, len);
-            auto subList = ParseList(l, subListStr);
+            auto subList = ParseList(l, subListStr, arena);
 
             l->InsertIntegerOrList(subList);
             idx += len;
@@ -186,7 +166,7 @@ std::shared_ptr<ListNode> ParseList(std::shared_ptr<ListNode> parent, const std:
             const auto len = substrIdx - idx;
             const auto intStr = workingString.substr(idx, len);
 
-            l->InsertIntegerOrList(ParseInteger(l, intStr));
+            l->InsertIntegerOrList(ParseInteger(l, intStr, arena));
             idx += len;
         }
     }
@@ -201,21 +181,19 @@ enum Outcome
     Inconclusive
 };
 
-Outcome CompareLists(const std::shared_ptr<ListNode> lhsRoot, const std::shared_ptr<ListNode> rhsRoot)
-{
-    auto lhsContents = lhsRoot->GetContents();
-    auto rhsContents = rhsRoot->GetContents();
+Outcome CompareLists(const ListNode* lhsRoot, const ListNode* rhsRoot);
 
-    for (auto rhsIt = rhsContents.begin(), lhsIt = lhsContents.begin();
-        rhsIt != rhsContents.end() && lhsIt != lhsContents.end(); ++rhsIt, ++lhsIt)
+// Compares the items of two lists. An integer that has to be compared against a list is passed
+// in as a list of one item that points at the integer itself, so no temporary list is built.
+Outcome CompareItems(const Node* const* lhsItems, const size_t lhsSize, const Node* const* rhsItems, const size_t rhsSize)
+{
+    ADVENT_OF_CODE_COUNT("exercise13.compare_lists_calls");
+    for (size_t i = 0; i < lhsSize && i < rhsSize; ++i)
     {
-        auto lhsPtr = *lhsIt;
-        auto rhsPtr = *rhsIt;
-
-        std::shared_ptr<ListNode> lhsAsList = dynamic_pointer_cast<ListNode>(lhsPtr);
-        std::shared_ptr<IntegerNode> lhsAsInt = dynamic_pointer_cast<IntegerNode>(lhsPtr);
-        std::shared_ptr<ListNode> rhsAsList = dynamic_pointer_cast<ListNode>(rhsPtr);
-        std::shared_ptr<IntegerNode> rhsAsInt = dynamic_pointer_cast<IntegerNode>(rhsPtr);
+        const auto lhsAsList = dynamic_cast<const ListNode*>(lhsItems[i]);
+        const auto lhsAsInt = dynamic_cast<const IntegerNode*>(lhsItems[i]);
+        const auto rhsAsList = dynamic_cast<const ListNode*>(rhsItems[i]);
+        const auto rhsAsInt = dynamic_cast<const IntegerNode*>(rhsItems[i]);
         
         if (lhsAsList && rhsAsList)
         {
@@ -253,10 +231,8 @@ Outcome CompareLists(const std::shared_ptr<ListNode> lhsRoot, const std::shared_
         }
         else if (lhsAsInt && rhsAsList)
         {
-            auto parent = lhsAsInt->GetParent();
-            auto asList = std::make_shared<ListNode>(parent);
-            asList->InsertIntegerOrList(lhsAsInt);
-            const auto outcome = CompareLists(asList, rhsAsList);
+            const auto& rhsContents = rhsAsList->GetContents();
+            const auto outcome = CompareItems(&lhsItems[i], 1, rhsContents.data(), rhsContents.size());
             if (outcome == Outcome::Inconclusive)
             {
                 continue;
@@ -266,10 +242,8 @@ Outcome CompareLists(const std::shared_ptr<ListNode> lhsRoot, const std::shared_
         }
         else if (lhsAsList && rhsAsInt)
         {
-            auto parent = rhsAsInt->GetParent();
-            auto asList = std::make_shared<ListNode>(parent);
-            asList->InsertIntegerOrList(rhsAsInt);
-            const auto outcome = CompareLists(lhsAsList, asList);
+            const auto& lhsContents = lhsAsList->GetContents();
+            const auto outcome = CompareItems(lhsContents.data(), lhsContents.size(), &rhsItems[i], 1);
             if (outcome == Outcome::Inconclusive)
             {
                 continue;
@@ -279,11 +253,11 @@ Outcome CompareLists(const std::shared_ptr<ListNode> lhsRoot, const std::shared_
         }
     }
 
-    if (lhsContents.size() < rhsContents.size())
+    if (lhsSize < rhsSize)
     {
         return Outcome::Right;
     }
-    else if (lhsContents.size() > rhsContents.size())
+    else if (lhsSize > rhsSize)
     {
         return Outcome::Wrong;
     }
@@ -291,113 +265,151 @@ Outcome CompareLists(const std::shared_ptr<ListNode> lhsRoot, const std::shared_
     return Outcome::Inconclusive;
 }
 
-void AdventOfCodeExercise13_Part1()
+Outcome CompareLists(const ListNode* lhsRoot, const ListNode* rhsRoot)
+{
+    const auto& lhsContents = lhsRoot->GetContents();
+    const auto& rhsContents = rhsRoot->GetContents();
+    return CompareItems(lhsContents.data(), lhsContents.size(), rhsContents.data(), rhsContents.size());
+}
+
+bool ComparePart2(
+    const std::pair<std::string_view, const ListNode*>& lhs,
+    const std::pair<std::string_view, const ListNode*>& rhs)
+{
+    if (CompareLists(lhs.second, rhs.second) == Outcome::Right)
+        return true;
+    
+    return false;
+}
+
+const char* const dividerPacket1 = "[[2]]";
+const char* const dividerPacket2 = "[[6]]";
+
+class Solver : public AdventOfCodeUtils::ExerciseSolver
 {
-    auto lines = ReadTextFile("input_exercise_13.txt");
-    assert(lines.size() > 0);
+public:
+    Solver() = default;
+    ~Solver() = default;
 
-    uint32_t lineCount = 0;
-    std::vector<std::shared_ptr<ListNode> > lhsExpressions;
-    std::vector<std::shared_ptr<ListNode> > rhsExpressions;
-    for (const auto& line : lines)
+    const char* GetName() const override
     {
-        if (lineCount == 0)
-        {
-            lhsExpressions.push_back(ParseList(nullptr, line));
-            lineCount++;
-        }
-        else if (lineCount == 1)
-        {
-            rhsExpressions.push_back(ParseList(nullptr, line));
-            lineCount++;
-        }
-        else
-        {
-            lineCount = 0;
-        }
+        return "exercise13";
     }
 
-    assert(lhsExpressions.size() == rhsExpressions.size());
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_13.txt";
+    }
 
-    std::vector<Outcome> outcomes;
-    outcomes.reserve(lhsExpressions.size());
-    std::vector<uint32_t> indicesOfCorrectlyOrderedPackets;
-    for (auto i = 0; i < lhsExpressions.size(); ++i)
+    // Packets come in pairs separated by a blank line. Part 1 compares each pair, part 2 sorts
+    // all of them together with the two divider packets.
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
     {
-        const auto outcome = CompareLists(lhsExpressions[i], rhsExpressions[i]);
-        switch (outcome)
+        assert(lines.size() > 0);
+        m_lhsExpressions.clear();
+        m_rhsExpressions.clear();
+        m_packetStrAndRootNodes.clear();
+        m_arena.Reset();
+
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise13.build");
+        uint32_t lineCount = 0;
+        for (const auto& line : lines)
         {
-            case Outcome::Right:
+            if (lineCount == 0)
             {
-                indicesOfCorrectlyOrderedPackets.push_back(i + 1);
-                break;
+                m_lhsExpressions.push_back(ParseList(nullptr, line, m_arena));
+                m_packetStrAndRootNodes.push_back(std::make_pair(line, m_lhsExpressions.back()));
+                lineCount++;
             }
-            default:
+            else if (lineCount == 1)
             {
-                continue;
+                m_rhsExpressions.push_back(ParseList(nullptr, line, m_arena));
+                m_packetStrAndRootNodes.push_back(std::make_pair(line, m_rhsExpressions.back()));
+                lineCount++;
+            }
+            else
+            {
+                lineCount = 0;
             }
-
         }
+
+        assert(m_lhsExpressions.size() == m_rhsExpressions.size());
+
+        // Insert divider packets
+        m_packetStrAndRootNodes.push_back(std::make_pair(dividerPacket1, ParseList(nullptr, dividerPacket1, m_arena)));
+        m_packetStrAndRootNodes.push_back(std::make_pair(dividerPacket2, ParseList(nullptr, dividerPacket2, m_arena)));
     }
 
-    auto totalPart1 = 0;
-    for (const auto& i : indicesOfCorrectlyOrderedPackets)
+    AdventOfCodeUtils::Answers Solve() const override
     {
-        totalPart1 += i;
+        return { std::to_string(SolvePart1()), std::to_string(SolvePart2()) };
     }
 
-    std::cout << "Part 1: " << totalPart1 << std::endl;
-}
+private:
+    uint32_t SolvePart1() const
+    {
+        std::vector<uint32_t> indicesOfCorrectlyOrderedPackets;
+        for (uint32_t i = 0; i < m_lhsExpressions.size(); ++i)
+        {
+            const auto outcome = CompareLists(m_lhsExpressions[i], m_rhsExpressions[i]);
+            switch (outcome)
+            {
+                case Outcome::Right:
+                {
+                    indicesOfCorrectlyOrderedPackets.push_back(i + 1);
+                    break;
+                }
+                default:
+                {
+                    continue;
+                }
 
-bool ComparePart2(
-    const std::pair<std::string, std::shared_ptr<ListNode> >& lhs,
-    const std::pair<std::string, std::shared_ptr<ListNode> >& rhs)
-{
-    if (CompareLists(lhs.second, rhs.second) == Outcome::Right)
-        return true;
-    
-    return false;
-}
+            }
+        }
 
-void AdventOfCodeExercise13_Part2()
-{
-    auto lines = ReadTextFile("input_exercise_13.txt");
-    assert(lines.size() > 0);
-
-    // Insert divider packets
-    const auto dividerPacket1 = "[[2]]";
-    const auto dividerPacket2 = "[[6]]";
-    lines.push_back(dividerPacket1);
-    lines.push_back(dividerPacket2);
-
-    // Create an associative list
-    std::vector<std::pair<std::string, std::shared_ptr<ListNode> > > packetStrAndRootNodes;
-    packetStrAndRootNodes.reserve(lines.size());
-    for (const auto& line : lines)
-    {
-        if (line.empty())
-            continue;
+        auto totalPart1 = 0;
+        for (const auto& i : indicesOfCorrectlyOrderedPackets)
+        {
+            totalPart1 += i;
+        }
 
-        packetStrAndRootNodes.push_back(std::make_pair(line, ParseList(nullptr, line)));
+        return totalPart1;
     }
 
-    std::sort(packetStrAndRootNodes.begin(), packetStrAndRootNodes.end(), ComparePart2);
-
-    auto totalPart2 = 1;
-    for (auto i = 0; i < packetStrAndRootNodes.size(); ++i)
+    uint32_t SolvePart2() const
     {
-        if (packetStrAndRootNodes[i].first == dividerPacket1 ||
-        packetStrAndRootNodes[i].first == dividerPacket2)
+        auto packetStrAndRootNodes = m_packetStrAndRootNodes;
+        std::sort(packetStrAndRootNodes.begin(), packetStrAndRootNodes.end(), ComparePart2);
+
+        auto totalPart2 = 1;
+        for (uint32_t i = 0; i < packetStrAndRootNodes.size(); ++i)
         {
-            totalPart2 *= i + 1;
+            if (packetStrAndRootNodes[i].first == dividerPacket1 ||
+            packetStrAndRootNodes[i].first == dividerPacket2)
+            {
+                totalPart2 *= i + 1;
+            }
         }
+
+        return totalPart2;
     }
 
-    std::cout << "Part 2: " << totalPart2 << std::endl;
+    AdventOfCodeUtils::NodeArena m_arena;
+    std::vector<const ListNode*> m_lhsExpressions;
+    std::vector<const ListNode*> m_rhsExpressions;
+    std::vector<std::pair<std::string_view, const ListNode*> > m_packetStrAndRootNodes;
+};
 }
 
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise13Solver()
+{
+    return std::make_unique<Exercise13::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise13_Part1();
-    AdventOfCodeExercise13_Part2();
-}
\ No newline at end of file
+    Exercise13::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
@@ -1,43 +1,18 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
-
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+#include <algorithm>
+#include <climits>
+#include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
+
+namespace Exercise14
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile, line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
 struct BoundingBox
 {
     int xMin;
@@ -49,24 +24,31 @@ struct BoundingBox
 class RockFormation
 {
 public:
-    RockFormation(const std::string& inputStr)
+    RockFormation(std::string_view inputStr)
     {
         std::vector<int> xCoords;
         std::vector<int> yCoords;
 
         //498,4 -> 498,6 -> 496,6
-        const auto tokens = Split(inputStr, ' ');
+        AdventOfCodeUtils::Tokenizer tokenizer(inputStr);
         std::vector<std::pair<int, int> > rockFormationEndPoints;
-        for (const auto& token : tokens)
+        std::string_view token;
+        while (tokenizer.Next(token))
         {
             if (token == "->")
                 continue;
             
-            const auto coordinateStrs = Split(token, ',');
-            assert(coordinateStrs.size() == 2);
-
-            const auto x = std::stoi(coordinateStrs[0]);
-            const auto y = std::stoi(coordinateStrs[1]);
+            AdventOfCodeUtils::Tokenizer coordinateTokenizer(token, ',');
+            std::string_view xStr;
+            std::string_view yStr;
+            const auto hasBothCoordinates = coordinateTokenizer.Next(xStr) && coordinateTokenizer.Next(yStr);
+            assert(hasBothCoordinates);
+
+            int x = 0;
+            int y = 0;
+            const auto parsedCoordinates =
+                AdventOfCodeUtils::ParseInteger(xStr, x) && AdventOfCodeUtils::ParseInteger(yStr, y);
+            assert(parsedCoordinates);
 
             xCoords.push_back(x);
             yCoords.push_back(y);            
@@ -151,6 +133,7 @@ public:
     Cave(const std::vector<RockFormation>& rockFormations)
         : m_rockFormations(rockFormations)
     {
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise14.build");
         m_bottomOfLowestRockFormation = INT_MIN;
         for (const auto& formation : m_rockFormations)
         {
@@ -194,8 +177,10 @@ public:
     {
         const auto source = std::make_pair(500, 0);
         auto position = source;
+        ADVENT_OF_CODE_COUNT("exercise14.drop_sand_calls");
         while (true)
         {
+            ADVENT_OF_CODE_COUNT("exercise14.drop_sand_steps");
             // A unit of sand always falls down one step if possible.
             auto below = std::make_pair(position.first, position.second + 1);
             
@@ -254,29 +239,60 @@ private:
     int m_bottomOfLowestRockFormation;
 };
 
-void AdventOfCodeExercise14()
+class Solver : public AdventOfCodeUtils::ExerciseSolver
 {
-    const auto lines = ReadTextFile("input_exercise_14.txt");
+public:
+    Solver() = default;
+    ~Solver() = default;
 
-    std::vector<RockFormation> rockFormations;
-    rockFormations.reserve(lines.size());
-    for (const auto& line : lines)
+    const char* GetName() const override
     {
-        RockFormation r(line);
-        rockFormations.push_back(r);
+        return "exercise14";
     }
 
-    Cave cave(rockFormations);
-    bool enterTheVoid = false;
-    while (!enterTheVoid)
+    const char* GetInputFilename() const override
     {
-        enterTheVoid = cave.DropSand();
+        return "input_exercise_14.txt";
     }
 
-    std::cout << cave.CountSand() << std::endl;
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        m_rockFormations.clear();
+        m_rockFormations.reserve(lines.size());
+        for (const auto& line : lines)
+        {
+            RockFormation r(line);
+            m_rockFormations.push_back(r);
+        }
+    }
+
+    // The cave has a floor, so this is the amount of sand that fills it up to the source (part 2)
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        Cave cave(m_rockFormations);
+        bool enterTheVoid = false;
+        while (!enterTheVoid)
+        {
+            enterTheVoid = cave.DropSand();
+        }
+
+        return { "", std::to_string(cave.CountSand()) };
+    }
+
+private:
+    std::vector<RockFormation> m_rockFormations;
+};
 }
 
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise14Solver()
+{
+    return std::make_unique<Exercise14::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise14();
-}
\ No newline at end of file
+    Exercise14::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
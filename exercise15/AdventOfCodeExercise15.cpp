@@ -1,51 +1,25 @@
 
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stack>
 #include <math.h>
 #include <set>
+#include <algorithm>
+#include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise15
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
-std::string Trim(const std::string& str,
-                 const std::string& whitespace = " \t")
+std::string_view Trim(std::string_view str,
+                      std::string_view whitespace = " \t")
 {
     const auto strBegin = str.find_first_not_of(whitespace);
-    if (strBegin == std::string::npos)
+    if (strBegin == std::string_view::npos)
         return ""; // no content
 
     const auto strEnd = str.find_last_not_of(whitespace);
@@ -232,11 +206,22 @@ private:
     std::vector<Line> m_lines;
 };
 
-int ParseLocationExpression(const std::string expr)
+int ParseLocationExpression(std::string_view expr)
 {
-    const auto exprTokens = Split(expr, '=');
-    assert(exprTokens.size() == 2);
-    return std::stoi(exprTokens.at(1));
+    AdventOfCodeUtils::Tokenizer tokenizer(expr, '=');
+    std::string_view name;
+    std::string_view value;
+    const auto hasNameAndValue = tokenizer.Next(name) && tokenizer.Next(value);
+    assert(hasNameAndValue);
+
+    // The x coordinate is followed by a comma
+    if (!value.empty() && value.back() == ',')
+        value.remove_suffix(1);
+
+    int coordinate = 0;
+    const auto parsed = AdventOfCodeUtils::ParseInteger(value, coordinate);
+    assert(parsed);
+    return coordinate;
 }
 
 const Range BallHorizontalLineIntersection(const TaxicabBall& ball, int y)
@@ -264,23 +249,26 @@ const Range BallHorizontalLineIntersection(const TaxicabBall& ball, int y)
     return Range(false, xmin, xmax);
 }
 
-const std::vector<TaxicabBall> ParseInput()
+std::vector<TaxicabBall> ParseInput(const AdventOfCodeUtils::MappedTextFile& lines)
 {
-    const auto lines = ReadTextFile("input_exercise_15.txt");
+    ADVENT_OF_CODE_SCOPED_TIMER("exercise15.build");
 
     std::vector<TaxicabBall> balls;
     std::set<std::pair<int, int> > beacons;
     for (const auto& line : lines)
     {
         // Sensor at x=2, y=18: closest beacon is at x=-2, y=15
-        const auto sensorAndBeacon = Split(line, ':');
-        assert(sensorAndBeacon.size() == 2);
-
-        const auto sensorTokens = Split(sensorAndBeacon[0], ' ');
+        AdventOfCodeUtils::Tokenizer sensorAndBeacon(line, ':');
+        std::string_view sensorStr;
+        std::string_view beaconStr;
+        const auto hasSensorAndBeacon = sensorAndBeacon.Next(sensorStr) && sensorAndBeacon.Next(beaconStr);
+        assert(hasSensorAndBeacon);
 
         // Sensor at x=2, y=18
+        AdventOfCodeUtils::Tokenizer sensorTokens(sensorStr);
         std::pair<int, int> sensor;
-        for (const auto& sensorToken : sensorTokens)
+        std::string_view sensorToken;
+        while (sensorTokens.Next(sensorToken))
         {
             assert(sensorToken.size() > 0);
             if (sensorToken.at(0) == 'x')
@@ -294,12 +282,11 @@ const std::vector<TaxicabBall> ParseInput()
             }
         }
 
-        const auto beaconStr = Trim(sensorAndBeacon[1]);
-
         // closest beacon is at x=-2, y=15
-        const auto beaconTokens = Split(beaconStr, ' ');
+        AdventOfCodeUtils::Tokenizer beaconTokens(Trim(beaconStr));
         std::pair<int, int> beacon;
-        for (const auto& beaconToken : beaconTokens)
+        std::string_view beaconToken;
+        while (beaconTokens.Next(beaconToken))
         {
             assert(beaconToken.size() > 0);
             if (beaconToken.at(0) == 'x')
@@ -373,22 +360,17 @@ const std::vector<Range> ComputeIntersection(
     return asVector;
 }
 
-void AdventOfCodeExercise15_Part1()
+const int AdventOfCodeExercise15_Part1(const std::vector<TaxicabBall>& balls)
 {
-    const auto balls = ParseInput();
-
     const int y = 2000000;
     auto intersection = ComputeIntersection(balls, y);
     assert(intersection.size() == 1);
 
-    std::cout << "Part 1:" << std::endl;
-    std::cout << intersection.at(0).Size() << std::endl;
+    return intersection.at(0).Size();
 }
 
-void AdventOfCodeExercise15_Part2()
+const long int AdventOfCodeExercise15_Part2(const std::vector<TaxicabBall>& balls)
 {
-    const auto balls = ParseInput();
-
     const auto xMin = 0;
     const auto xMax = 4000000;
     const auto yMin = 0;
@@ -411,20 +393,17 @@ void AdventOfCodeExercise15_Part2()
             std::sort(intersection.begin(), intersection.end(), RangeComparison);
             xCoordOfBeacon = intersection.at(0).GetMax() + 1;
             yCoordOfBeacon = i;
-            std::cout << "(" << xCoordOfBeacon << "," << yCoordOfBeacon << ")" << std::endl;
             break;
         }
     }
 
-    const auto output = static_cast<long int>(xCoordOfBeacon) * 4000000 + static_cast<long int>(yCoordOfBeacon);
-    std::cout << output << std::endl;
+    return static_cast<long int>(xCoordOfBeacon) * 4000000 + static_cast<long int>(yCoordOfBeacon);
 }
 
 // This approach is super fast, but it currently fails to find the solution point
 // Not worth debugging at this point, but I'll keep it around as a reference for later.
-void AdventOfCodeExercise15_Part2_LinearAlgebra()
+void AdventOfCodeExercise15_Part2_LinearAlgebra(const std::vector<TaxicabBall>& balls)
 {
-    const auto balls = ParseInput();
 
     const auto xMin = 0;
     const auto xMax = 4000000;
@@ -482,8 +461,49 @@ void AdventOfCodeExercise15_Part2_LinearAlgebra()
     }
 }
 
+class Solver : public AdventOfCodeUtils::ExerciseSolver
+{
+public:
+    Solver() = default;
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise15";
+    }
+
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_15.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        m_balls = ParseInput(lines);
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        const auto totalPart1 = AdventOfCodeExercise15_Part1(m_balls);
+        const auto totalPart2 = AdventOfCodeExercise15_Part2(m_balls);
+
+        return { std::to_string(totalPart1), std::to_string(totalPart2) };
+    }
+
+private:
+    std::vector<TaxicabBall> m_balls;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise15Solver()
+{
+    return std::make_unique<Exercise15::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise15_Part1();
-    AdventOfCodeExercise15_Part2();
-}
\ No newline at end of file
+    Exercise15::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
@@ -1,72 +1,157 @@
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
-#include <sstream>
-#include <stack>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <assert.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise5
 {
-    std::ifstream myfile;
-    std::string line;
+const uint32_t crateStringLength = 4;
+
+// The crates of one stack in a single contiguous buffer, bottom crate first. Moving a block of
+// crates from the top of one stack to another is then one copy instead of a pop and push per
+// crate.
+class CrateStack
+{
+public:
+    CrateStack() = default;
+    ~CrateStack() = default;
 
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
+    void Push(const char crate)
     {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
+        m_crates.push_back(crate);
+    }
 
-        myfile.close();
+    void Reserve(const size_t numCrates)
+    {
+        m_crates.reserve(numCrates);
     }
-    return output;
-}
 
-const uint32_t crateStringLength = 4;
+    char Top() const
+    {
+        assert(!m_crates.empty());
+        return m_crates.back();
+    }
+
+    size_t Size() const
+    {
+        return m_crates.size();
+    }
+
+    // The top crate is at depth 0
+    char CrateAtDepth(const size_t depth) const
+    {
+        assert(depth < m_crates.size());
+        return m_crates[m_crates.size() - 1 - depth];
+    }
+
+    // Moves the top quantity crates on top of destination, keeping their order (CrateMover9001)
+    void MoveBlockTo(CrateStack& destination, const size_t quantity)
+    {
+        assert(quantity <= m_crates.size());
+        if (&destination == this)
+            return;
+
+        const auto blockStart = m_crates.end() - quantity;
+        destination.m_crates.insert(destination.m_crates.end(), blockStart, m_crates.end());
+        m_crates.resize(m_crates.size() - quantity);
+    }
+
+    // Same, but the block ends up upside down, which is what moving the crates one at a time
+    // onto another stack does (CrateMover9000). Moving them one at a time onto their own stack
+    // puts every crate back where it was.
+    void MoveReversedBlockTo(CrateStack& destination, const size_t quantity)
+    {
+        assert(quantity <= m_crates.size());
+        if (&destination == this)
+            return;
+
+        const auto blockStart = m_crates.end() - quantity;
+        const auto destinationSize = destination.m_crates.size();
+        destination.m_crates.resize(destinationSize + quantity);
+        std::reverse_copy(blockStart, m_crates.end(), destination.m_crates.begin() + destinationSize);
+        m_crates.resize(m_crates.size() - quantity);
+    }
+
+private:
+    std::vector<char> m_crates;
+};
+
+// The row under the drawing that numbers the stacks, " 1   2   3 "
+bool IsStackNumbersRow(std::string_view row)
+{
+    return row.length() > 1 && row[0] == ' ' && row[1] >= '0' && row[1] <= '9';
+}
 
-void InsertRowIntoCrateStacks(const std::string& row, std::vector<std::stack<char> >& stacks)
+// A crate can only start at a multiple of crateStringLength, so 16 characters at a time are
+// compared against '[' and only the matches at those positions are kept
+void InsertRowIntoCrateStacks(std::string_view row, std::vector<CrateStack>& stacks)
 {
-    const uint32_t rowLength = row.length() + 1;
-    for (auto i = 0; i < rowLength; ++i)
+    size_t position = 0;
+#if defined(__SSE2__)
+    static_assert(crateStringLength == 4, "The match mask assumes a crate every 4 characters");
+    const __m128i bracket = _mm_set1_epi8('[');
+    // The last crate of a block has its letter inside the block too
+    while (position + 16 <= row.length())
     {
-        auto stackIndex = i / crateStringLength;
-        if (row[i] == '[')
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.data() + position));
+        auto matches = _mm_movemask_epi8(_mm_cmpeq_epi8(block, bracket)) & 0x1111;
+        while (matches != 0)
         {
-            stacks[stackIndex].push(row[i+1]);
+            const auto offset = position + __builtin_ctz(matches);
+            stacks[offset / crateStringLength].Push(row[offset + 1]);
+            matches &= matches - 1;
         }
+
+        position += 16;
+    }
+#endif
+
+    for (; position + 1 < row.length(); position += crateStringLength)
+    {
+        if (row[position] == '[')
+            stacks[position / crateStringLength].Push(row[position + 1]);
     }
 }
 
-std::vector<std::stack<char> > BuildCrateStacksFromRows(const std::vector<std::string>& rows)
+std::vector<CrateStack> BuildCrateStacksFromRows(const std::vector<std::string_view>& rows)
 {
-    const auto rowLength = rows[0].length() + 1;
-    const auto numStacks = rowLength / crateStringLength;
-    
-    std::vector<std::vector<char> > cratesAsVectors(numStacks);
+    ADVENT_OF_CODE_SCOPED_TIMER("exercise5.build");
+
+    // Editors like to strip the trailing spaces, so the rows don't all have to be as wide
+    size_t rowLength = 0;
     for (const auto& row : rows)
     {
-        for (auto i = 0; i < rowLength; ++i)
-        {
-            auto stackIndex = i / crateStringLength;
-            if (row[i] == '[')
-            {
-                cratesAsVectors[stackIndex].push_back(row[i+1]);
-            }
-        }
+        rowLength = std::max(rowLength, row.length() + 1);
     }
 
-    std::vector<std::stack<char> > crateStacks(rowLength / crateStringLength);
-    auto crateIndex = 0;
-    for (auto v : cratesAsVectors)
+    const auto numStacks = rowLength / crateStringLength;
+
+    // The drawing is top down and the stacks are bottom up, so go through the rows backwards.
+    // No stack can be taller than the drawing.
+    std::vector<CrateStack> crateStacks(numStacks);
+    for (auto& stack : crateStacks)
     {
-        std::reverse(v.begin(), v.end());
-        for (auto crate : v)
-        {
-            crateStacks[crateIndex].push(crate);
-        }
-        crateIndex++;
+        stack.Reserve(rows.size());
+    }
+
+    for (auto row = rows.rbegin(); row != rows.rend(); ++row)
+    {
+        InsertRowIntoCrateStacks(*row, crateStacks);
     }
 
     return crateStacks;
@@ -79,109 +164,1420 @@ struct CrateMoveInstruction
     uint32_t quantity;
 };
 
-const CrateMoveInstruction BuildInstructionFromRow(const std::string& row)
+const CrateMoveInstruction BuildInstructionFromRow(std::string_view row)
 {
-    std::vector<std::string> strings;
-    std::istringstream f(row);
-    std::string s;
-    while(std::getline(f, s, ' '))
-    {
-        strings.push_back(s);
-    }
+    // move <quantity> from <stack> to <stack>
+    AdventOfCodeUtils::Tokenizer tokenizer(row);
+    std::string_view keyword;
+    std::string_view value;
 
     CrateMoveInstruction instruction;
-    for (auto i = 0; i < strings.size(); ++i)
+    while (tokenizer.Next(keyword) && tokenizer.Next(value))
     {
-        if (strings[i] == "move")
-            instruction.quantity = std::stoi(strings[i+1]);
-        else if (strings[i] == "from")
-            instruction.from = std::stoi(strings[i+1]) - 1;
-        else if (strings[i] == "to")
-            instruction.to = std::stoi(strings[i+1]) - 1;
+        uint32_t number = 0;
+        const auto parsed = AdventOfCodeUtils::ParseInteger(value, number);
+        assert(parsed);
+
+        if (keyword == "move")
+            instruction.quantity = number;
+        else if (keyword == "from")
+            instruction.from = number - 1;
+        else if (keyword == "to")
+            instruction.to = number - 1;
     }
     
     return instruction;
 }
 
-void CrateMover9000(const CrateMoveInstruction& instruction, std::vector<std::stack<char> >& crateStacks)
+// Read-only list of instructions, which either live in the solver or straight in a mapped
+// compiled program
+class CrateMoveProgram
+{
+public:
+    CrateMoveProgram()
+        : m_instructions(nullptr)
+        , m_size(0) {}
+    CrateMoveProgram(const CrateMoveInstruction* instructions, const size_t size)
+        : m_instructions(instructions)
+        , m_size(size) {}
+    ~CrateMoveProgram() = default;
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    const CrateMoveInstruction& operator[](const size_t index) const
+    {
+        return m_instructions[index];
+    }
+
+    const CrateMoveInstruction* begin() const
+    {
+        return m_instructions;
+    }
+
+    const CrateMoveInstruction* end() const
+    {
+        return m_instructions + m_size;
+    }
+
+    std::reverse_iterator<const CrateMoveInstruction*> rbegin() const
+    {
+        return std::reverse_iterator<const CrateMoveInstruction*>(end());
+    }
+
+    std::reverse_iterator<const CrateMoveInstruction*> rend() const
+    {
+        return std::reverse_iterator<const CrateMoveInstruction*>(begin());
+    }
+
+private:
+    const CrateMoveInstruction* m_instructions;
+    size_t m_size;
+};
+
+// A compiled program is a header followed by the instructions exactly as they are laid out in
+// memory, so a mapped program runs without parsing or copying anything. It is in the byte order
+// of the machine that compiled it.
+static_assert(sizeof(CrateMoveInstruction) == 3 * sizeof(uint32_t), "Compiled instructions have no padding");
+static_assert(std::is_trivially_copyable<CrateMoveInstruction>::value, "Compiled instructions are copied as bytes");
+
+struct CompiledProgramHeader
+{
+    char magic[8];
+    uint64_t numInstructions;
+};
+
+const char compiledProgramMagic[8] = { 'A', 'o', 'C', '5', 'M', 'O', 'V', '1' };
+
+bool WriteCompiledProgram(const std::string& filename, const CrateMoveProgram& program)
+{
+    CompiledProgramHeader header;
+    memcpy(header.magic, compiledProgramMagic, sizeof(header.magic));
+    header.numInstructions = program.size();
+
+    std::ofstream output(filename, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(program.begin()), program.size() * sizeof(CrateMoveInstruction));
+    return static_cast<bool>(output);
+}
+
+// Returns false if the file isn't a complete compiled program
+bool ReadCompiledProgram(const AdventOfCodeUtils::MappedFile& file, CrateMoveProgram& program /* out */)
 {
-    for (auto i = 0; i < instruction.quantity; ++i)
+    CompiledProgramHeader header;
+    if (!file.IsOpen() || file.GetSize() < sizeof(header))
+        return false;
+
+    memcpy(&header, file.GetData(), sizeof(header));
+    const auto instructionBytes = file.GetSize() - sizeof(header);
+    if (memcmp(header.magic, compiledProgramMagic, sizeof(header.magic)) != 0 ||
+        instructionBytes % sizeof(CrateMoveInstruction) != 0 ||
+        header.numInstructions != instructionBytes / sizeof(CrateMoveInstruction))
     {
-        crateStacks[instruction.to].push(crateStacks[instruction.from].top());
-        crateStacks[instruction.from].pop();
+        return false;
     }
+
+    // The mapping is page aligned and the header keeps the instructions aligned after it
+    const auto* instructions = reinterpret_cast<const CrateMoveInstruction*>(file.GetData() + sizeof(header));
+    program = CrateMoveProgram(instructions, header.numInstructions);
+    return true;
 }
 
-void CrateMover9001(const CrateMoveInstruction& instruction, std::vector<std::stack<char> >& crateStacks)
+// A compiled program can be run against any drawing, so it has to be checked against the stacks
+// before it runs. Follows only the stack heights. Returns false and the index of the first
+// instruction that names a missing stack or moves more crates than its source stack holds.
+bool ProgramFitsCrateStacks(
+    const CrateMoveProgram& program, const std::vector<CrateStack>& crateStacks, size_t& badInstruction /* out */)
 {
-    std::vector<char> temp;
-    for (auto i = 0; i < instruction.quantity; ++i)
+    std::vector<uint64_t> heights;
+    heights.reserve(crateStacks.size());
+    for (const auto& stack : crateStacks)
     {
-        temp.push_back(crateStacks[instruction.from].top());
-        crateStacks[instruction.from].pop();
+        heights.push_back(stack.Size());
     }
 
-    std::reverse(temp.begin(), temp.end());
-    for (auto crate : temp)
+    for (size_t i = 0; i < program.size(); ++i)
     {
-        crateStacks[instruction.to].push(crate);
+        const auto& instruction = program[i];
+        if (instruction.from >= heights.size() || instruction.to >= heights.size() ||
+            instruction.quantity > heights[instruction.from])
+        {
+            badInstruction = i;
+            return false;
+        }
+
+        heights[instruction.from] -= instruction.quantity;
+        heights[instruction.to] += instruction.quantity;
     }
+
+    return true;
 }
 
-void Exercise5()
+void CrateMover9000(const CrateMoveInstruction& instruction, std::vector<CrateStack>& crateStacks)
 {
-    std::string filename("input_exercise_5.txt");
-    const auto inputRows = ReadTextFile(filename);
-    
-    std::vector<std::stack<char> > crateStacksPart1;
-    std::vector<std::stack<char> > crateStacksPart2;
-    std::vector<std::string> rows;
-    bool parsingCrateStacks = true;
-    for (const auto& row : inputRows)
-    {   
-        if (row.empty())
+    crateStacks[instruction.from].MoveReversedBlockTo(crateStacks[instruction.to], instruction.quantity);
+}
+
+void CrateMover9001(const CrateMoveInstruction& instruction, std::vector<CrateStack>& crateStacks)
+{
+    crateStacks[instruction.from].MoveBlockTo(crateStacks[instruction.to], instruction.quantity);
+}
+
+const std::string StackTops(const std::vector<CrateStack>& crateStacks)
+{
+    std::string tops;
+    for (const auto& stack : crateStacks)
+    {
+        tops.push_back(stack.Top());
+    }
+
+    return tops;
+}
+
+// Runs the instructions on a thread pool, a window at a time. Inside a window every instruction
+// gets the level after the last instruction that touched either of its stacks, so the
+// instructions of one level touch different stacks and can run at the same time, and running
+// the levels in order leaves the stacks exactly as running the instructions in order would.
+void RunInParallel(
+    const CrateMoveProgram& instructions,
+    std::vector<CrateStack>& crateStacksPart1,
+    std::vector<CrateStack>& crateStacksPart2,
+    AdventOfCodeUtils::ThreadPool& pool)
+{
+    ADVENT_OF_CODE_SCOPED_TIMER("exercise5.run_in_parallel");
+    const size_t windowSize = 16384;
+    // Smaller levels aren't worth waking the pool up for
+    const size_t minParallelLevelSize = 256;
+
+    // One past the level of the last instruction in the window that touched the stack
+    std::vector<uint32_t> stackLevels(crateStacksPart1.size(), 0);
+    std::vector<std::vector<const CrateMoveInstruction*> > levels;
+    const auto runInstructions = [&crateStacksPart1, &crateStacksPart2](
+        const CrateMoveInstruction* const* begin, const CrateMoveInstruction* const* end)
+    {
+        for (auto instruction = begin; instruction != end; ++instruction)
+        {
+            CrateMover9000(**instruction, crateStacksPart1);
+            CrateMover9001(**instruction, crateStacksPart2);
+        }
+    };
+
+    for (size_t windowStart = 0; windowStart < instructions.size(); windowStart += windowSize)
+    {
+        const auto windowEnd = std::min(windowStart + windowSize, instructions.size());
+        size_t numLevels = 0;
+        for (size_t i = windowStart; i < windowEnd; ++i)
+        {
+            const auto& instruction = instructions[i];
+            const auto level = std::max(stackLevels[instruction.from], stackLevels[instruction.to]);
+            stackLevels[instruction.from] = stackLevels[instruction.to] = level + 1;
+
+            // The level vectors are kept between windows so they don't have to grow again
+            if (level == numLevels)
+            {
+                if (levels.size() == numLevels)
+                    levels.emplace_back();
+
+                levels[numLevels++].clear();
+            }
+
+            levels[level].push_back(&instruction);
+        }
+
+        ADVENT_OF_CODE_COUNT_N("exercise5.parallel_levels", numLevels);
+        for (size_t level = 0; level < numLevels; ++level)
+        {
+            const auto& levelInstructions = levels[level];
+            if (levelInstructions.size() < minParallelLevelSize || pool.GetNumThreads() == 1)
+            {
+                runInstructions(levelInstructions.data(), levelInstructions.data() + levelInstructions.size());
+                continue;
+            }
+
+            const auto chunkSize = (levelInstructions.size() + pool.GetNumThreads() - 1) / pool.GetNumThreads();
+            for (size_t chunkStart = 0; chunkStart < levelInstructions.size(); chunkStart += chunkSize)
+            {
+                const auto* begin = levelInstructions.data() + chunkStart;
+                const auto* end = levelInstructions.data() + std::min(chunkStart + chunkSize, levelInstructions.size());
+                pool.Submit([&runInstructions, begin, end] { runInstructions(begin, end); });
+            }
+
+            pool.Wait();
+        }
+
+        for (size_t i = windowStart; i < windowEnd; ++i)
+        {
+            stackLevels[instructions[i].from] = stackLevels[instructions[i].to] = 0;
+        }
+    }
+}
+
+// Where a crate is, as its stack and how many crates are on top of it
+struct CratePosition
+{
+    uint32_t stack;
+    uint64_t depth;
+};
+
+// Where the crate that is at position after the instruction was before it. keepsOrder is true
+// for the CrateMover9001, which moves the whole block at once.
+CratePosition TraceBack(const CrateMoveInstruction& instruction, const CratePosition& position, const bool keepsOrder)
+{
+    // Moving crates onto their own stack leaves it as it was, with either machine
+    if (instruction.from == instruction.to)
+        return position;
+
+    if (position.stack == instruction.to)
+    {
+        // Below the moved block the crate was already there
+        if (position.depth >= instruction.quantity)
+            return { position.stack, position.depth - instruction.quantity };
+
+        const auto depthInSource = keepsOrder ? position.depth : instruction.quantity - 1 - position.depth;
+        return { instruction.from, depthInSource };
+    }
+
+    if (position.stack == instruction.from)
+    {
+        // The moved block used to sit on top of it
+        return { position.stack, position.depth + instruction.quantity };
+    }
+
+    return position;
+}
+
+// Works out the final top crates without moving any crates. Each top is followed backwards
+// through the instructions to where it started, so the cost is instructions x stacks no matter
+// how many crates the instructions move.
+const std::string TraceStackTops(
+    const std::vector<CrateStack>& initialCrateStacks,
+    const CrateMoveProgram& instructions,
+    const bool keepsOrder)
+{
+    std::vector<CratePosition> positions;
+    positions.reserve(initialCrateStacks.size());
+    for (uint32_t stack = 0; stack < initialCrateStacks.size(); ++stack)
+    {
+        positions.push_back({ stack, 0 });
+    }
+
+    for (auto instruction = instructions.rbegin(); instruction != instructions.rend(); ++instruction)
+    {
+        for (auto& position : positions)
+        {
+            position = TraceBack(*instruction, position, keepsOrder);
+        }
+    }
+
+    std::string tops;
+    for (const auto& position : positions)
+    {
+        tops.push_back(initialCrateStacks[position.stack].CrateAtDepth(position.depth));
+    }
+
+    return tops;
+}
+
+// Every stack as an implicit treap: a randomly balanced binary tree ordered by position in the
+// stack instead of by key. Taking the top block off a stack is a split and putting it onto
+// another is a merge, and the CrateMover9000 turning the block over is a lazy flag on its root,
+// so every move is O(log n) however many crates it moves.
+//
+// The crates never change, they only move between stacks, so all of them live in one pool and
+// the trees link to each other by index.
+class CrateTreapForest
+{
+public:
+    CrateTreapForest(const std::vector<CrateStack>& crateStacks)
+        : m_random(5)
+    {
+        for (const auto& stack : crateStacks)
+        {
+            // Bottom crate first, the in-order position is the height in the stack
+            uint32_t root = nullNode;
+            for (size_t height = 0; height < stack.Size(); ++height)
+            {
+                root = Merge(root, CreateNode(stack.CrateAtDepth(stack.Size() - 1 - height)));
+            }
+
+            m_roots.push_back(root);
+        }
+    }
+
+    ~CrateTreapForest() = default;
+
+    void Move(const CrateMoveInstruction& instruction, const bool keepsOrder)
+    {
+        const auto sourceSize = Size(m_roots[instruction.from]);
+        assert(instruction.quantity <= sourceSize);
+
+        // Moving crates onto their own stack leaves it as it was, with either machine
+        if (instruction.from == instruction.to)
+            return;
+
+        uint32_t rest;
+        uint32_t block;
+        Split(m_roots[instruction.from], sourceSize - instruction.quantity, rest, block);
+        if (!keepsOrder && block != nullNode)
+            m_nodes[block].reversed = !m_nodes[block].reversed;
+
+        m_roots[instruction.from] = rest;
+        m_roots[instruction.to] = Merge(m_roots[instruction.to], block);
+    }
+
+    uint32_t GetNumStacks() const
+    {
+        return static_cast<uint32_t>(m_roots.size());
+    }
+
+    uint64_t StackSize(const uint32_t stack) const
+    {
+        return Size(m_roots[stack]);
+    }
+
+    // The top crate is at depth 0
+    char CrateAtDepth(const uint32_t stack, const uint64_t depth) const
+    {
+        auto node = m_roots[stack];
+        assert(depth < Size(node));
+        auto index = Size(node) - 1 - depth;
+
+        // Reversal flags further up apply to everything below them, so they are collected on
+        // the way down instead of being pushed into the tree
+        bool reversed = false;
+        while (true)
+        {
+            const auto& n = m_nodes[node];
+            reversed = reversed != n.reversed;
+            const auto left = reversed ? n.right : n.left;
+            const auto right = reversed ? n.left : n.right;
+
+            const auto leftSize = Size(left);
+            if (index < leftSize)
+            {
+                node = left;
+            }
+            else if (index == leftSize)
+            {
+                return n.crate;
+            }
+            else
+            {
+                index -= leftSize + 1;
+                node = right;
+            }
+        }
+    }
+
+    const std::string Tops() const
+    {
+        std::string tops;
+        for (uint32_t stack = 0; stack < m_roots.size(); ++stack)
         {
-            parsingCrateStacks = false;
-            crateStacksPart1 = BuildCrateStacksFromRows(rows);
-            crateStacksPart2 = crateStacksPart1;
-            continue;
+            tops.push_back(CrateAtDepth(stack, 0));
         }
-        else if (row.at(0) == ' ')
+
+        return tops;
+    }
+
+private:
+    static const uint32_t nullNode = UINT32_MAX;
+
+    struct Node
+    {
+        uint32_t left;
+        uint32_t right;
+        uint32_t size;
+        uint32_t priority;
+        char crate;
+        // The children of this subtree still have to be swapped
+        bool reversed;
+    };
+
+    uint32_t CreateNode(const char crate)
+    {
+        m_nodes.push_back({ nullNode, nullNode, 1, static_cast<uint32_t>(m_random()), crate, false });
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    uint32_t Size(const uint32_t node) const
+    {
+        return node == nullNode ? 0 : m_nodes[node].size;
+    }
+
+    void PushReversal(const uint32_t node)
+    {
+        auto& n = m_nodes[node];
+        if (!n.reversed)
+            return;
+
+        std::swap(n.left, n.right);
+        if (n.left != nullNode)
+            m_nodes[n.left].reversed = !m_nodes[n.left].reversed;
+        if (n.right != nullNode)
+            m_nodes[n.right].reversed = !m_nodes[n.right].reversed;
+        n.reversed = false;
+    }
+
+    void UpdateSize(const uint32_t node)
+    {
+        auto& n = m_nodes[node];
+        n.size = Size(n.left) + Size(n.right) + 1;
+    }
+
+    // Splits off the first leftSize crates (counted from the bottom) into left, the rest go into right
+    void Split(const uint32_t node, const uint32_t leftSize, uint32_t& left /* out */, uint32_t& right /* out */)
+    {
+        if (node == nullNode)
         {
-            // Skip the stack numbers (they start with a space)
-            continue;
+            left = right = nullNode;
+            return;
         }
 
-        // The first "paragraph" of the input are the initial state of the stacks
-        if (parsingCrateStacks)
+        PushReversal(node);
+        auto& n = m_nodes[node];
+        if (Size(n.left) < leftSize)
         {
-            rows.push_back(row);
+            uint32_t rightOfRight;
+            Split(n.right, leftSize - Size(n.left) - 1, m_nodes[node].right, rightOfRight);
+            left = node;
+            right = rightOfRight;
         }
         else
         {
-            const auto instruction = BuildInstructionFromRow(row);
-            CrateMover9000(instruction, crateStacksPart1);
-            CrateMover9001(instruction, crateStacksPart2);
+            uint32_t leftOfLeft;
+            Split(n.left, leftSize, leftOfLeft, m_nodes[node].left);
+            left = leftOfLeft;
+            right = node;
         }
+
+        UpdateSize(node);
+    }
+
+    // Every crate in left ends up below every crate in right
+    uint32_t Merge(const uint32_t left, const uint32_t right)
+    {
+        if (left == nullNode)
+            return right;
+        if (right == nullNode)
+            return left;
+
+        if (m_nodes[left].priority > m_nodes[right].priority)
+        {
+            PushReversal(left);
+            const auto mergedRight = Merge(m_nodes[left].right, right);
+            m_nodes[left].right = mergedRight;
+            UpdateSize(left);
+            return left;
+        }
+
+        PushReversal(right);
+        const auto mergedLeft = Merge(left, m_nodes[right].left);
+        m_nodes[right].left = mergedLeft;
+        UpdateSize(right);
+        return right;
     }
 
-    std::cout << "Part 1:" << std::endl;
-    for (const auto& stack : crateStacksPart1)
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_roots;
+    std::mt19937 m_random;
+};
+
+// The crate at depth (the top crate is at depth 0) of a stack after only the first
+// numInstructions instructions
+struct CrateQuery
+{
+    size_t numInstructions;
+    uint32_t stack;
+    uint64_t depth;
+};
+
+// Answers all the queries for one of the movers with a single forest that runs through the
+// instructions once, in the order of the queries' prefixes, so each query costs O(log n) on
+// top of the moves. crates is in the same order as queries. Returns false if a query asks for
+// more instructions than there are, or for a crate that isn't there.
+bool QueryCratesAtDepth(
+    const std::vector<CrateStack>& initialCrateStacks,
+    const CrateMoveProgram& instructions,
+    const std::vector<CrateQuery>& queries,
+    const bool keepsOrder,
+    std::vector<char>& crates /* out */)
+{
+    ADVENT_OF_CODE_SCOPED_TIMER("exercise5.query_crates");
+    std::vector<size_t> order(queries.size());
+    for (size_t i = 0; i < order.size(); ++i)
     {
-        const auto top = stack.top();
-        std::cout << top;
+        order[i] = i;
     }
 
-    std::cout << "\n" << std::endl;
-    std::cout << "Part 2:" << std::endl;
-    for (const auto& stack : crateStacksPart2)
+    std::stable_sort(order.begin(), order.end(), [&queries](const size_t a, const size_t b)
+    {
+        return queries[a].numInstructions < queries[b].numInstructions;
+    });
+
+    CrateTreapForest forest(initialCrateStacks);
+    crates.assign(queries.size(), 0);
+    size_t numInstructions = 0;
+    for (const auto index : order)
     {
-        const auto top = stack.top();
-        std::cout << top;
+        const auto& query = queries[index];
+        if (query.numInstructions > instructions.size())
+            return false;
+
+        for (; numInstructions < query.numInstructions; ++numInstructions)
+        {
+            forest.Move(instructions[numInstructions], keepsOrder);
+        }
+
+        if (query.stack >= forest.GetNumStacks() || query.depth >= forest.StackSize(query.stack))
+            return false;
+
+        crates[index] = forest.CrateAtDepth(query.stack, query.depth);
     }
+
+    return true;
 }
 
-int main()
+// Snapshots of the stacks of both movers every interval instructions, so the stacks after any
+// number of instructions can be had by replaying at most interval instructions from the nearest
+// snapshot. Snapshots share the stacks that didn't change since the previous snapshot, so a
+// smaller interval only costs memory for the stacks that actually moved. The instructions have
+// to outlive the checkpoints.
+class CrateCheckpoints
 {
-    Exercise5();
-}
\ No newline at end of file
+public:
+    CrateCheckpoints(
+        const std::vector<CrateStack>& initialCrateStacks,
+        const CrateMoveProgram& instructions,
+        const size_t interval)
+        : m_instructions(instructions)
+        , m_interval(std::max<size_t>(1, interval))
+        , m_storedCrates(0)
+    {
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise5.build_checkpoints");
+        for (const auto keepsOrder : { false, true })
+        {
+            auto& checkpoints = m_checkpoints[keepsOrder];
+            auto crateStacks = initialCrateStacks;
+            std::vector<bool> changed(crateStacks.size(), true);
+            for (size_t i = 0; ; ++i)
+            {
+                if (i % m_interval == 0)
+                    checkpoints.push_back(CreateSnapshot(crateStacks, checkpoints, changed));
+
+                if (i == m_instructions.size())
+                    break;
+
+                const auto& instruction = m_instructions[i];
+                if (keepsOrder)
+                    CrateMover9001(instruction, crateStacks);
+                else
+                    CrateMover9000(instruction, crateStacks);
+
+                changed[instruction.from] = changed[instruction.to] = true;
+            }
+        }
+    }
+
+    ~CrateCheckpoints() = default;
+
+    // The top crate of every stack after the first numInstructions instructions, with a space
+    // for an empty stack. Returns false if there aren't that many instructions.
+    bool StackTopsAfter(const size_t numInstructions, const bool keepsOrder, std::string& tops /* out */) const
+    {
+        Snapshot crateStacks;
+        if (!Replay(numInstructions, keepsOrder, crateStacks))
+            return false;
+
+        tops.clear();
+        for (const auto& stack : crateStacks)
+        {
+            tops.push_back(stack->Size() > 0 ? stack->Top() : ' ');
+        }
+
+        return true;
+    }
+
+    size_t GetNumCheckpoints() const
+    {
+        return m_checkpoints[0].size();
+    }
+
+    // Across all snapshots of both movers
+    uint64_t GetNumStoredCrates() const
+    {
+        return m_storedCrates;
+    }
+
+private:
+    typedef std::vector<std::shared_ptr<const CrateStack> > Snapshot;
+
+    // The stacks after the first numInstructions instructions, replayed from the checkpoint
+    // before them. Returns false if there aren't that many instructions.
+    bool Replay(const size_t numInstructions, const bool keepsOrder, Snapshot& crateStacks /* out */) const
+    {
+        if (numInstructions > m_instructions.size())
+            return false;
+
+        // Only the stacks the replayed instructions touch get copied out of the snapshot
+        crateStacks = m_checkpoints[keepsOrder][numInstructions / m_interval];
+        std::vector<std::shared_ptr<CrateStack> > copies(crateStacks.size());
+        const auto writable = [&crateStacks, &copies](const uint32_t stack) -> CrateStack&
+        {
+            if (!copies[stack])
+            {
+                copies[stack] = std::make_shared<CrateStack>(*crateStacks[stack]);
+                crateStacks[stack] = copies[stack];
+            }
+
+            return *copies[stack];
+        };
+
+        for (auto i = numInstructions - numInstructions % m_interval; i < numInstructions; ++i)
+        {
+            const auto& instruction = m_instructions[i];
+            auto& source = writable(instruction.from);
+            auto& destination = writable(instruction.to);
+            if (keepsOrder)
+                source.MoveBlockTo(destination, instruction.quantity);
+            else
+                source.MoveReversedBlockTo(destination, instruction.quantity);
+        }
+
+        return true;
+    }
+
+    Snapshot CreateSnapshot(
+        const std::vector<CrateStack>& crateStacks,
+        const std::vector<Snapshot>& checkpoints,
+        std::vector<bool>& changed)
+    {
+        Snapshot snapshot;
+        snapshot.reserve(crateStacks.size());
+        for (size_t stack = 0; stack < crateStacks.size(); ++stack)
+        {
+            if (!changed[stack])
+            {
+                snapshot.push_back(checkpoints.back()[stack]);
+                continue;
+            }
+
+            snapshot.push_back(std::make_shared<const CrateStack>(crateStacks[stack]));
+            m_storedCrates += crateStacks[stack].Size();
+            changed[stack] = false;
+        }
+
+        return snapshot;
+    }
+
+    const CrateMoveProgram m_instructions;
+    const size_t m_interval;
+    // Indexed by keepsOrder, so the CrateMover 9000 first
+    std::vector<Snapshot> m_checkpoints[2];
+    uint64_t m_storedCrates;
+};
+
+enum class Strategy
+{
+    // Move every crate
+    Simulate,
+    // Only trace the top crates back to where they started
+    ReverseTrace,
+    // Move blocks of crates between treaps
+    Treap,
+    // Move every crate, running instructions on different stacks at the same time
+    Parallel
+};
+
+const char* GetStrategyName(const Strategy strategy)
+{
+    switch (strategy)
+    {
+    case Strategy::Simulate:
+        return "simulate";
+    case Strategy::ReverseTrace:
+        return "reverse trace";
+    case Strategy::Treap:
+        return "treap";
+    case Strategy::Parallel:
+        return "parallel";
+    }
+
+    assert(false);
+    return "";
+}
+
+// The pool is only used, and then needed, by the parallel strategy
+AdventOfCodeUtils::Answers SolveWithStrategy(
+    const Strategy strategy,
+    const std::vector<CrateStack>& initialCrateStacks,
+    const CrateMoveProgram& instructions,
+    AdventOfCodeUtils::ThreadPool* pool)
+{
+    if (strategy == Strategy::ReverseTrace)
+    {
+        return {
+            TraceStackTops(initialCrateStacks, instructions, false /* keepsOrder */),
+            TraceStackTops(initialCrateStacks, instructions, true /* keepsOrder */) };
+    }
+
+    if (strategy == Strategy::Treap)
+    {
+        CrateTreapForest stacksPart1(initialCrateStacks);
+        CrateTreapForest stacksPart2(initialCrateStacks);
+        for (const auto& instruction : instructions)
+        {
+            stacksPart1.Move(instruction, false /* keepsOrder */);
+            stacksPart2.Move(instruction, true /* keepsOrder */);
+        }
+
+        return { stacksPart1.Tops(), stacksPart2.Tops() };
+    }
+
+    auto crateStacksPart1 = initialCrateStacks;
+    auto crateStacksPart2 = initialCrateStacks;
+    if (strategy == Strategy::Parallel)
+    {
+        assert(pool);
+        RunInParallel(instructions, crateStacksPart1, crateStacksPart2, *pool);
+        return { StackTops(crateStacksPart1), StackTops(crateStacksPart2) };
+    }
+
+    for (const auto& instruction : instructions)
+    {
+        CrateMover9000(instruction, crateStacksPart1);
+        CrateMover9001(instruction, crateStacksPart2);
+    }
+
+    return { StackTops(crateStacksPart1), StackTops(crateStacksPart2) };
+}
+
+// The stacks as the puzzle describes them, with the top crate at the back of each
+typedef std::vector<std::vector<char> > ReferenceCrateStacks;
+
+// Moves the crates the way the machines in the puzzle do, which is far slower than moving
+// blocks. It is only there to check the strategies against.
+void ReferenceCrateMover(const CrateMoveInstruction& instruction, const bool keepsOrder, ReferenceCrateStacks& crateStacks)
+{
+    auto& source = crateStacks[instruction.from];
+    auto& destination = crateStacks[instruction.to];
+    if (!keepsOrder)
+    {
+        // The 9000 puts every crate down before it picks up the next one
+        for (uint32_t i = 0; i < instruction.quantity; ++i)
+        {
+            const auto crate = source.back();
+            source.pop_back();
+            destination.push_back(crate);
+        }
+
+        return;
+    }
+
+    // The 9001 picks them all up before putting any down
+    const std::vector<char> crane(source.end() - instruction.quantity, source.end());
+    source.resize(source.size() - instruction.quantity);
+    destination.insert(destination.end(), crane.begin(), crane.end());
+}
+
+// With a space for an empty stack
+const std::string ReferenceStackTops(const ReferenceCrateStacks& crateStacks)
+{
+    std::string tops;
+    for (const auto& stack : crateStacks)
+    {
+        tops.push_back(stack.empty() ? ' ' : stack.back());
+    }
+
+    return tops;
+}
+
+// Compares the checkpoint tops after the first numInstructions instructions with the reference
+// stacks after them
+bool VerifyCheckpoint(
+    const std::string& programName,
+    const CrateCheckpoints& checkpoints,
+    const size_t numInstructions,
+    const bool keepsOrder,
+    const ReferenceCrateStacks& crateStacks,
+    std::string& mismatch /* out */)
+{
+    std::string tops;
+    if (!checkpoints.StackTopsAfter(numInstructions, keepsOrder, tops) || tops != ReferenceStackTops(crateStacks))
+    {
+        mismatch = programName + ": the stack tops after " + std::to_string(numInstructions) +
+            " instructions are wrong for the " + (keepsOrder ? "9001" : "9000");
+        return false;
+    }
+
+    return true;
+}
+
+// Asks for the block the last instruction moved and the crate under it, which is where a wrong
+// move shows up first, and remembers what the reference stacks have there
+void AddMovedBlockQueries(
+    const CrateMoveProgram& instructions,
+    const size_t numInstructions,
+    const ReferenceCrateStacks& crateStacks,
+    std::vector<CrateQuery>& queries /* out */,
+    std::string& expectedCrates /* out */)
+{
+    if (numInstructions == 0)
+        return;
+
+    const auto& instruction = instructions[numInstructions - 1];
+    const auto& stack = crateStacks[instruction.to];
+    for (uint64_t depth = 0; depth < std::min<uint64_t>(stack.size(), instruction.quantity + 1); ++depth)
+    {
+        queries.push_back({ numInstructions, instruction.to, depth });
+        expectedCrates.push_back(stack[stack.size() - 1 - depth]);
+    }
+}
+
+// Compares the treap's answers to the queries with the crates the reference stacks had there
+bool VerifyCrateQueries(
+    const std::string& programName,
+    const std::vector<CrateStack>& initialCrateStacks,
+    const CrateMoveProgram& instructions,
+    const std::vector<CrateQuery>& queries,
+    const bool keepsOrder,
+    const std::string& expectedCrates,
+    std::string& mismatch /* out */)
+{
+    std::vector<char> crates;
+    const auto answered = QueryCratesAtDepth(initialCrateStacks, instructions, queries, keepsOrder, crates);
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        if (!answered || crates[i] != expectedCrates[i])
+        {
+            mismatch = programName + ": the crate at depth " + std::to_string(queries[i].depth) + " of stack " +
+                std::to_string(queries[i].stack + 1) + " after " + std::to_string(queries[i].numInstructions) +
+                " instructions is wrong for the " + (keepsOrder ? "9001" : "9000");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Runs the instructions with every strategy and compares the answers with moving the crates
+// one at a time, and does the same for the checkpoint tops and the crate queries after every
+// instruction. Returns false and describes the first difference in mismatch.
+bool VerifyProgram(
+    const std::string& programName,
+    const std::vector<CrateStack>& initialCrateStacks,
+    const CrateMoveProgram& instructions,
+    AdventOfCodeUtils::ThreadPool& pool,
+    std::string& mismatch /* out */)
+{
+    ReferenceCrateStacks referencePart1;
+    for (const auto& stack : initialCrateStacks)
+    {
+        referencePart1.emplace_back();
+        for (size_t depth = stack.Size(); depth > 0; --depth)
+            referencePart1.back().push_back(stack.CrateAtDepth(depth - 1));
+    }
+
+    // An interval that doesn't line up with anything, so queries replay a few instructions
+    const CrateCheckpoints checkpoints(initialCrateStacks, instructions, 7);
+    auto referencePart2 = referencePart1;
+    std::vector<CrateQuery> queriesPart1;
+    std::vector<CrateQuery> queriesPart2;
+    std::string expectedCratesPart1;
+    std::string expectedCratesPart2;
+    for (size_t i = 0; ; ++i)
+    {
+        if (!VerifyCheckpoint(programName, checkpoints, i, false /* keepsOrder */, referencePart1, mismatch) ||
+            !VerifyCheckpoint(programName, checkpoints, i, true /* keepsOrder */, referencePart2, mismatch))
+        {
+            return false;
+        }
+
+        AddMovedBlockQueries(instructions, i, referencePart1, queriesPart1, expectedCratesPart1);
+        AddMovedBlockQueries(instructions, i, referencePart2, queriesPart2, expectedCratesPart2);
+        if (i == instructions.size())
+            break;
+
+        ReferenceCrateMover(instructions[i], false /* keepsOrder */, referencePart1);
+        ReferenceCrateMover(instructions[i], true /* keepsOrder */, referencePart2);
+    }
+
+    if (!VerifyCrateQueries(programName, initialCrateStacks, instructions, queriesPart1, false /* keepsOrder */,
+            expectedCratesPart1, mismatch) ||
+        !VerifyCrateQueries(programName, initialCrateStacks, instructions, queriesPart2, true /* keepsOrder */,
+            expectedCratesPart2, mismatch))
+    {
+        return false;
+    }
+
+    // The answers need a crate on top of every stack
+    const auto expectedPart1 = ReferenceStackTops(referencePart1);
+    const auto expectedPart2 = ReferenceStackTops(referencePart2);
+    if (expectedPart1.find(' ') != std::string::npos)
+        return true;
+
+    for (const auto strategy : { Strategy::Simulate, Strategy::ReverseTrace, Strategy::Treap, Strategy::Parallel })
+    {
+        const auto answers = SolveWithStrategy(strategy, initialCrateStacks, instructions, &pool);
+        if (answers.part1 != expectedPart1 || answers.part2 != expectedPart2)
+        {
+            mismatch = programName + ": " + GetStrategyName(strategy) + " gives " + answers.part1 + " " +
+                answers.part2 + " instead of " + expectedPart1 + " " + expectedPart2;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The example from the puzzle with moves from a stack onto itself thrown in, which have to
+// leave that stack as it was
+const char* const sameStackExampleDrawing[] = { "    [D]    ", "[N] [C]    ", "[Z] [M] [P]" };
+const char* const sameStackExampleInstructions[] = {
+    "move 2 from 1 to 1",
+    "move 1 from 2 to 1",
+    "move 2 from 2 to 2",
+    "move 3 from 1 to 3",
+    "move 1 from 3 to 3",
+    "move 2 from 2 to 1",
+    "move 4 from 3 to 3",
+    "move 1 from 1 to 2" };
+
+class Solver : public AdventOfCodeUtils::StreamingExerciseSolver
+{
+public:
+    // The parallel strategy keeps its pool for as long as the solver lives, so solving again
+    // doesn't start new threads
+    Solver(const Strategy strategy = Strategy::Simulate)
+        : m_strategy(strategy)
+    {
+        if (m_strategy == Strategy::Parallel)
+            m_pool = std::make_unique<AdventOfCodeUtils::ThreadPool>();
+    }
+
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise5";
+    }
+
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_5.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& inputRows) override
+    {
+        m_initialCrateStacks.clear();
+        m_parsedInstructions.clear();
+
+        std::vector<std::string_view> rows;
+        bool parsingCrateStacks = true;
+        for (const auto& row : inputRows)
+        {   
+            if (row.empty())
+            {
+                parsingCrateStacks = false;
+                m_initialCrateStacks = BuildCrateStacksFromRows(rows);
+
+                // A compiled program replaces the instructions in the input
+                if (m_compiledProgramFile)
+                    break;
+
+                continue;
+            }
+            else if (IsStackNumbersRow(row))
+            {
+                continue;
+            }
+
+            // The first "paragraph" of the input are the initial state of the stacks
+            if (parsingCrateStacks)
+            {
+                rows.push_back(row);
+            }
+            else
+            {
+                m_parsedInstructions.push_back(BuildInstructionFromRow(row));
+            }
+        }
+
+        // An input with just the drawing doesn't need the empty line after it
+        if (parsingCrateStacks && !rows.empty())
+            m_initialCrateStacks = BuildCrateStacksFromRows(rows);
+
+        if (!m_compiledProgramFile)
+            m_instructions = CrateMoveProgram(m_parsedInstructions.data(), m_parsedInstructions.size());
+
+        // The input's own instructions are trusted like the rest of the input, a compiled
+        // program isn't
+        m_programFits = !m_compiledProgramFile ||
+            ProgramFitsCrateStacks(m_instructions, m_initialCrateStacks, m_badInstruction);
+    }
+
+    // Whether the instructions can run against the parsed stacks. If not, Solve gives no answers
+    // and badInstruction is the index of the first one that can't.
+    bool ProgramFits(size_t& badInstruction /* out */) const
+    {
+        badInstruction = m_badInstruction;
+        return m_programFits;
+    }
+
+    // Runs the instructions of a compiled program from now on instead of the ones in the input.
+    // The program stays mapped for as long as the solver is alive.
+    bool LoadCompiledProgram(const std::string& filename)
+    {
+        auto file = std::make_unique<const AdventOfCodeUtils::MappedFile>(filename);
+        CrateMoveProgram program;
+        if (!ReadCompiledProgram(*file, program))
+            return false;
+
+        m_compiledProgramFile = std::move(file);
+        m_instructions = program;
+        return true;
+    }
+
+    // Writes the current instructions as a compiled program
+    bool CompileProgram(const std::string& filename) const
+    {
+        return WriteCompiledProgram(filename, m_instructions);
+    }
+
+    size_t GetNumInstructions() const
+    {
+        return m_instructions.size();
+    }
+
+    // Only valid for as long as the solver is alive and not parsed again
+    std::unique_ptr<CrateCheckpoints> CreateCheckpoints(const size_t interval) const
+    {
+        return std::make_unique<CrateCheckpoints>(m_initialCrateStacks, m_instructions, interval);
+    }
+
+    // See QueryCratesAtDepth
+    bool QueryCratesAtDepth(
+        const std::vector<CrateQuery>& queries, const bool keepsOrder, std::vector<char>& crates /* out */) const
+    {
+        return Exercise5::QueryCratesAtDepth(m_initialCrateStacks, m_instructions, queries, keepsOrder, crates);
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        if (!m_programFits)
+            return {};
+
+        return SolveWithStrategy(m_strategy, m_initialCrateStacks, m_instructions, m_pool.get());
+    }
+
+    // Checks every strategy and both queries against moving the crates one at a time, on the
+    // input and on an example with moves from a stack onto itself. Returns false and describes
+    // the first difference in mismatch.
+    bool Verify(std::string& mismatch /* out */) const
+    {
+        const std::vector<std::string_view> exampleRows(
+            std::begin(sameStackExampleDrawing), std::end(sameStackExampleDrawing));
+        std::vector<CrateMoveInstruction> exampleInstructions;
+        for (const auto row : sameStackExampleInstructions)
+        {
+            exampleInstructions.push_back(BuildInstructionFromRow(row));
+        }
+
+        const CrateMoveProgram exampleProgram(exampleInstructions.data(), exampleInstructions.size());
+        // Every strategy runs, so the parallel one needs a pool even if this solver doesn't
+        std::unique_ptr<AdventOfCodeUtils::ThreadPool> verifyPool;
+        auto* pool = m_pool.get();
+        if (!pool)
+        {
+            verifyPool = std::make_unique<AdventOfCodeUtils::ThreadPool>();
+            pool = verifyPool.get();
+        }
+
+        return VerifyProgram("example", BuildCrateStacksFromRows(exampleRows), exampleProgram, *pool, mismatch) &&
+            VerifyProgram("input", m_initialCrateStacks, m_instructions, *pool, mismatch);
+    }
+
+    AdventOfCodeUtils::Answers SolveStreaming(AdventOfCodeUtils::StreamingLineReader& reader) const override
+    {
+        // The drawing has to be complete before the stacks can be built, so only its rows are
+        // copied out of the reader. The instructions are applied as they arrive.
+        std::vector<std::string> drawing;
+        std::string_view row;
+        while (reader.NextLine(row) && !row.empty())
+        {
+            if (!IsStackNumbersRow(row))
+                drawing.emplace_back(row);
+        }
+
+        const std::vector<std::string_view> rows(drawing.begin(), drawing.end());
+        auto crateStacksPart1 = BuildCrateStacksFromRows(rows);
+        auto crateStacksPart2 = crateStacksPart1;
+        while (reader.NextLine(row))
+        {
+            if (row.empty())
+                continue;
+
+            const auto instruction = BuildInstructionFromRow(row);
+            CrateMover9000(instruction, crateStacksPart1);
+            CrateMover9001(instruction, crateStacksPart2);
+        }
+
+        return { StackTops(crateStacksPart1), StackTops(crateStacksPart2) };
+    }
+
+private:
+    const Strategy m_strategy;
+    std::unique_ptr<AdventOfCodeUtils::ThreadPool> m_pool;
+    std::vector<CrateStack> m_initialCrateStacks;
+    std::vector<CrateMoveInstruction> m_parsedInstructions;
+    std::unique_ptr<const AdventOfCodeUtils::MappedFile> m_compiledProgramFile;
+    CrateMoveProgram m_instructions;
+    bool m_programFits = true;
+    size_t m_badInstruction = 0;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise5Solver()
+{
+    return std::make_unique<Exercise5::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
+namespace
+{
+
+// Usage:
+//   AdventOfCodeExercise5 [--stdin]
+//   AdventOfCodeExercise5 [--reverse-trace | --treap | --parallel] [--program compiled.bin]
+//   AdventOfCodeExercise5 [--program compiled.bin] --crate-at <instructions> <stack> <depth>...
+//   AdventOfCodeExercise5 [--program compiled.bin] [--checkpoint-interval N] --tops-after <instructions>...
+//   AdventOfCodeExercise5 --compile-program compiled.bin
+//   AdventOfCodeExercise5 [--program compiled.bin] --verify
+//
+// --reverse-trace works out the top crates without moving the rest, --treap moves whole blocks
+// and --parallel runs instructions on different stacks at the same time.
+// --compile-program writes the instructions of the input as a compiled program, which --program
+// then runs against the stacks drawn in the input instead of the input's own instructions. A
+// program that names a missing stack or moves more crates than a stack holds is rejected.
+// --crate-at prints the crate at that depth of that stack (from 1, top crate at depth 0) after
+// only the first <instructions> instructions, and can be given any number of times. All of them
+// are answered by one pass of the treaps over the instructions. --tops-after prints the top
+// crates after only the first <instructions> instructions, and can be given any number of
+// times. It replays from snapshots taken every --checkpoint-interval instructions (1000 by
+// default), so a smaller interval answers it faster and takes more memory. --verify checks every
+// strategy and both queries against moving the crates one at a time, which is slow, so it is
+// meant for small inputs.
+struct Options
+{
+    Exercise5::Strategy strategy = Exercise5::Strategy::Simulate;
+    std::string programFilename;
+    std::string compiledProgramFilename;
+    std::vector<Exercise5::CrateQuery> crateQueries;
+    size_t checkpointInterval = 1000;
+    std::vector<size_t> topsAfter;
+    bool verify = false;
+};
+
+bool ParseOptions(int argc, char** argv, Options& options /* out */)
+{
+    // RunExercise handles --stdin itself
+    if (argc == 2 && std::string_view(argv[1]) == "--stdin")
+        return true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view argument(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--reverse-trace")
+        {
+            options.strategy = Exercise5::Strategy::ReverseTrace;
+        }
+        else if (argument == "--treap")
+        {
+            options.strategy = Exercise5::Strategy::Treap;
+        }
+        else if (argument == "--parallel")
+        {
+            options.strategy = Exercise5::Strategy::Parallel;
+        }
+        else if (argument == "--verify")
+        {
+            options.verify = true;
+        }
+        else if (argument == "--program" && hasValue)
+        {
+            options.programFilename = argv[++i];
+        }
+        else if (argument == "--compile-program" && hasValue)
+        {
+            options.compiledProgramFilename = argv[++i];
+        }
+        else if (argument == "--checkpoint-interval" && hasValue)
+        {
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], options.checkpointInterval) || options.checkpointInterval == 0)
+                return false;
+        }
+        else if (argument == "--tops-after" && hasValue)
+        {
+            size_t numInstructions;
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], numInstructions))
+                return false;
+
+            options.topsAfter.push_back(numInstructions);
+        }
+        else if (argument == "--crate-at" && i + 3 < argc)
+        {
+            Exercise5::CrateQuery query;
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], query.numInstructions) ||
+                !AdventOfCodeUtils::ParseInteger(argv[++i], query.stack) ||
+                !AdventOfCodeUtils::ParseInteger(argv[++i], query.depth) ||
+                query.stack == 0)
+            {
+                return false;
+            }
+
+            // Stacks are numbered from 1 on the command line
+            --query.stack;
+            options.crateQueries.push_back(query);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ParseInput(Exercise5::Solver& solver)
+{
+    const AdventOfCodeUtils::MappedTextFile lines(solver.GetInputFilename());
+    if (!lines.IsOpen())
+    {
+        std::cerr << "Unable to open " << solver.GetInputFilename() << std::endl;
+        return false;
+    }
+
+    solver.Parse(lines);
+
+    size_t badInstruction;
+    if (!solver.ProgramFits(badInstruction))
+    {
+        std::cerr << "Instruction " << badInstruction + 1 << " of the program doesn't fit the stacks in "
+                  << solver.GetInputFilename() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " [--stdin] [--reverse-trace | --treap | --parallel] [--program FILE]"
+                  << " [--compile-program FILE] [--crate-at INSTRUCTIONS STACK DEPTH]..."
+                  << " [--checkpoint-interval N] [--tops-after INSTRUCTIONS]... [--verify]" << std::endl;
+        return 1;
+    }
+
+    Exercise5::Solver solver(options.strategy);
+    if (!options.programFilename.empty() && !solver.LoadCompiledProgram(options.programFilename))
+    {
+        std::cerr << options.programFilename << " is not a compiled program" << std::endl;
+        return 1;
+    }
+
+    if (!options.compiledProgramFilename.empty())
+    {
+        if (!ParseInput(solver))
+            return 1;
+
+        if (!solver.CompileProgram(options.compiledProgramFilename))
+        {
+            std::cerr << "Unable to write " << options.compiledProgramFilename << std::endl;
+            return 1;
+        }
+
+        std::cout << "Compiled " << solver.GetNumInstructions() << " instructions" << std::endl;
+        return 0;
+    }
+
+    if (options.verify)
+    {
+        if (!ParseInput(solver))
+            return 1;
+
+        std::string mismatch;
+        if (!solver.Verify(mismatch))
+        {
+            std::cerr << mismatch << std::endl;
+            return 1;
+        }
+
+        std::cout << "Every strategy and query matches moving the crates one at a time" << std::endl;
+        return 0;
+    }
+
+    if (!options.crateQueries.empty())
+    {
+        if (!ParseInput(solver))
+            return 1;
+
+        std::vector<char> cratesPart1;
+        std::vector<char> cratesPart2;
+        if (!solver.QueryCratesAtDepth(options.crateQueries, false /* keepsOrder */, cratesPart1) ||
+            !solver.QueryCratesAtDepth(options.crateQueries, true /* keepsOrder */, cratesPart2))
+        {
+            std::cerr << "No such crate" << std::endl;
+            return 1;
+        }
+
+        for (size_t i = 0; i < options.crateQueries.size(); ++i)
+        {
+            const auto& query = options.crateQueries[i];
+            std::cout << query.numInstructions << " " << query.stack + 1 << " " << query.depth << ": "
+                      << cratesPart1[i] << " " << cratesPart2[i] << std::endl;
+        }
+
+        return 0;
+    }
+
+    if (!options.topsAfter.empty())
+    {
+        if (!ParseInput(solver))
+            return 1;
+
+        const auto checkpoints = solver.CreateCheckpoints(options.checkpointInterval);
+        std::cerr << checkpoints->GetNumCheckpoints() << " checkpoints holding "
+                  << checkpoints->GetNumStoredCrates() << " crates" << std::endl;
+
+        for (const auto numInstructions : options.topsAfter)
+        {
+            std::string topsPart1;
+            std::string topsPart2;
+            if (!checkpoints->StackTopsAfter(numInstructions, false /* keepsOrder */, topsPart1) ||
+                !checkpoints->StackTopsAfter(numInstructions, true /* keepsOrder */, topsPart2))
+            {
+                std::cerr << "There are only " << solver.GetNumInstructions() << " instructions" << std::endl;
+                return 1;
+            }
+
+            std::cout << numInstructions << ": " << topsPart1 << " " << topsPart2 << std::endl;
+        }
+
+        return 0;
+    }
+
+    // RunExercise parses the input again, but with a program loaded that is just the drawing
+    if (!options.programFilename.empty() && !ParseInput(solver))
+        return 1;
+
+    return AdventOfCodeUtils::RunExercise(solver, argc, argv);
+}
+#endif
@@ -1,44 +1,539 @@
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <assert.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
-#include <sstream>
-#include <fstream>
-#include <set>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define EXERCISE6_AVX2
+#endif
 #include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-uint32_t FindPositionOfPacketMarker(const std::string& line, const uint32_t sequenceLength)
+namespace Exercise6
 {
-    for (auto i = 0; i < line.length(); ++i)
+// The longest possible marker has every byte value in it once
+const uint32_t maxSequenceLength = 256;
+
+#ifdef EXERCISE6_AVX2
+// The AVX2 kernel keeps one bit per position in a 64 bit mask, which limits how far back it
+// can look
+const uint32_t maxAvx2SequenceLength = 32;
+
+bool FindPositionOfPacketMarkerAvx2(std::string_view line, const uint32_t sequenceLength, size_t& position /* out */);
+
+bool CanUseAvx2Kernel(const uint32_t sequenceLength)
+{
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    return hasAvx2 && sequenceLength >= 2 && sequenceLength <= maxAvx2SequenceLength;
+}
+#endif
+
+// Finds the marker in a stream that is fed to it a piece at a time, for streams that are still
+// arriving. It slides a window over the stream, keeping a count of every byte in it and of how
+// many byte values are in it more than once, so every byte is the same small amount of work.
+// The window itself is kept too, since it can straddle two pieces. Feeding never allocates.
+class PacketMarkerDetector
+{
+public:
+    // The length has to be from 1 to maxSequenceLength
+    PacketMarkerDetector(const uint32_t sequenceLength)
+        : m_sequenceLength(sequenceLength)
+    {
+        assert(sequenceLength > 0 && sequenceLength <= maxSequenceLength);
+        Reset();
+    }
+
+    ~PacketMarkerDetector() = default;
+
+    void Reset()
+    {
+        std::fill(std::begin(m_counts), std::end(m_counts), 0);
+        m_duplicates = 0;
+        m_windowIndex = 0;
+        m_streamLength = 0;
+        m_found = false;
+    }
+
+    // Returns true once the stream so far has a marker in it, with the position just past the
+    // end of its first window, counted from the start of the stream. Bytes fed after that are
+    // ignored.
+    bool Feed(std::string_view bytes, size_t& position /* out */)
+    {
+        const auto streamStart = m_streamLength;
+
+        // The windows that reach back into earlier pieces go through the counts
+        const auto straddling = std::min<size_t>(bytes.length(), m_sequenceLength - 1);
+        FeedBytes(bytes.substr(0, straddling));
+
+#ifdef EXERCISE6_AVX2
+        // The windows inside a big piece go through the AVX2 kernel, and then the counts start
+        // over from the piece's last window
+        const size_t minKernelPieceLength = 4096;
+        if (!m_found && bytes.length() >= minKernelPieceLength && CanUseAvx2Kernel(m_sequenceLength))
+        {
+            size_t piecePosition = 0;
+            m_found = FindPositionOfPacketMarkerAvx2(bytes, m_sequenceLength, piecePosition);
+            if (m_found)
+            {
+                m_streamLength = streamStart + piecePosition;
+            }
+            else
+            {
+                RestartWindow(bytes.substr(bytes.length() - m_sequenceLength));
+                m_streamLength = streamStart + bytes.length();
+            }
+
+            position = m_streamLength;
+            return m_found;
+        }
+#endif
+
+        FeedBytes(bytes.substr(straddling));
+        position = m_streamLength;
+        return m_found;
+    }
+
+private:
+    void FeedBytes(std::string_view bytes)
+    {
+        for (size_t i = 0; i < bytes.length() && !m_found; ++i)
+        {
+            const auto incoming = static_cast<unsigned char>(bytes[i]);
+            if (m_counts[incoming]++ == 1)
+                ++m_duplicates;
+
+            // The byte that falls out of the window is in the slot the new one goes into
+            auto& slot = m_window[m_windowIndex];
+            if (m_streamLength >= m_sequenceLength && --m_counts[slot] == 1)
+                --m_duplicates;
+
+            slot = incoming;
+            m_windowIndex = m_windowIndex + 1 == m_sequenceLength ? 0 : m_windowIndex + 1;
+            ++m_streamLength;
+
+            m_found = m_duplicates == 0 && m_streamLength >= m_sequenceLength;
+        }
+    }
+
+    // Refills the counts and the window with a full window's worth of bytes
+    void RestartWindow(std::string_view window)
+    {
+        assert(window.length() == m_sequenceLength);
+        std::fill(std::begin(m_counts), std::end(m_counts), 0);
+        m_duplicates = 0;
+        for (size_t i = 0; i < window.length(); ++i)
+        {
+            const auto byte = static_cast<unsigned char>(window[i]);
+            if (m_counts[byte]++ == 1)
+                ++m_duplicates;
+
+            m_window[i] = byte;
+        }
+
+        m_windowIndex = 0;
+    }
+
+    const uint32_t m_sequenceLength;
+    uint32_t m_counts[256];
+    uint32_t m_duplicates;
+    // The last sequenceLength bytes, oldest at m_windowIndex once it's full
+    unsigned char m_window[maxSequenceLength];
+    uint32_t m_windowIndex;
+    size_t m_streamLength;
+    bool m_found;
+};
+
+// The position is just past the end of the first window without duplicates. Returns false if
+// there is no such window.
+bool FindPositionOfPacketMarkerScalar(std::string_view line, const uint32_t sequenceLength, size_t& position /* out */)
+{
+    PacketMarkerDetector detector(sequenceLength);
+    return detector.Feed(line, position);
+}
+
+#ifdef EXERCISE6_AVX2
+// Checks 64 window positions at a time with bit masks. Two bytes at distance d that are equal
+// rule out every window that holds both of them: with the second one at p, that's the windows
+// ending at p up to p + (sequenceLength - 1 - d). So the mask of equal pairs at distance d is
+// spread over that many positions, and a window ending at a position that no mask reaches is a
+// marker. Going from d = 1 up, every mask gets spread one more position than the next one, so
+// it's a single shift per distance.
+//
+// A window can also be ruled out by pairs up to sequenceLength - 2 positions before the block,
+// so the blocks overlap by that much and only the bits after the overlap are answers.
+__attribute__((target("avx2")))
+bool FindPositionOfPacketMarkerAvx2(std::string_view line, const uint32_t sequenceLength, size_t& position /* out */)
+{
+    const char* const data = line.data();
+    const size_t overlap = sequenceLength - 2;
+    const uint64_t answerBits = ~0ull << overlap;
+
+    // Before the first block, where the block can't look back far enough
+    size_t start = sequenceLength - 1;
+    if (line.length() < start + 64)
+        return FindPositionOfPacketMarkerScalar(line, sequenceLength, position);
+
+    if (FindPositionOfPacketMarkerScalar(line.substr(0, start + overlap), sequenceLength, position))
+        return true;
+
+    for (; start + 64 <= line.length(); start += 64 - overlap)
     {
-        std::set<char> charSequence;
-        for (auto j = i; j < i + sequenceLength; ++j)
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + start));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + start + 32));
+
+        uint64_t ruledOut = 0;
+        for (uint32_t distance = 1; distance < sequenceLength; ++distance)
         {
-            charSequence.insert(line[j]);
+            const auto* earlier = data + start - distance;
+            const __m256i earlierLow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(earlier));
+            const __m256i earlierHigh = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(earlier + 32));
+            const uint64_t equalLow = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, earlierLow)));
+            const uint64_t equalHigh = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, earlierHigh)));
+            ruledOut = (ruledOut | (ruledOut << 1)) | equalLow | (equalHigh << 32);
         }
 
-        if (charSequence.size() == sequenceLength)
+        const auto markers = ~ruledOut & answerBits;
+        if (markers != 0)
         {
-            return i + sequenceLength;
+            position = start + __builtin_ctzll(markers) + 1;
+            return true;
         }
     }
+
+    // The windows after the last block, the first of them starts one before the next block
+    if (!FindPositionOfPacketMarkerScalar(line.substr(start - 1), sequenceLength, position))
+        return false;
+
+    position += start - 1;
+    return true;
 }
+#endif
 
-void Exercise6()
+// Returns false if there is no marker, or for a length of 0 or over maxSequenceLength. Uses
+// the AVX2 kernel when the CPU has it and the marker is short enough.
+bool FindPositionOfPacketMarker(std::string_view line, const uint32_t sequenceLength, size_t& position /* out */)
 {
-    const auto inputLine = AdventOfCodeUtils::ReadTextFile("input_exercise_6.txt")[0];
+    if (sequenceLength == 0 || sequenceLength > maxSequenceLength)
+        return false;
+
+#ifdef EXERCISE6_AVX2
+    if (CanUseAvx2Kernel(sequenceLength))
+        return FindPositionOfPacketMarkerAvx2(line, sequenceLength, position);
+#endif
+
+    return FindPositionOfPacketMarkerScalar(line, sequenceLength, position);
+}
+
+// Splits the line into chunks that overlap by sequenceLength - 1, so every window is whole in
+// one of them, and scans them on the pool. Each task keeps taking the next chunk in order and
+// stops once a marker was found before that chunk. Chunks are scanned a block at a time and
+// the same check is made before every block, so a task that is already in a chunk past the
+// first marker gives up after at most one block. Must not be called from inside a task of the
+// pool.
+bool FindPositionOfPacketMarkerParallel(
+    std::string_view line,
+    const uint32_t sequenceLength,
+    AdventOfCodeUtils::ThreadPool& pool,
+    size_t& position /* out */)
+{
+    // Big enough that the overlap and the task overhead don't matter, small enough that a
+    // marker found early doesn't leave much scanning behind it
+    const size_t chunkSize = 1 << 20;
+    const size_t blockSize = 1 << 16;
+    if (line.length() <= chunkSize || pool.GetNumThreads() == 1)
+        return FindPositionOfPacketMarker(line, sequenceLength, position);
+
+    if (sequenceLength == 0 || sequenceLength > maxSequenceLength)
+        return false;
+
+    const auto numChunks = (line.length() + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<size_t> firstMarker(std::string_view::npos);
+    const auto scanChunks = [&]()
+    {
+        while (true)
+        {
+            const auto chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= numChunks)
+                return;
+
+            const auto chunkStart = chunk * chunkSize;
+            const auto chunkEnd = std::min(chunkStart + chunkSize, line.length());
+            for (auto blockStart = chunkStart; blockStart < chunkEnd; blockStart += blockSize)
+            {
+                // Later chunks start even further along, so there is nothing left for this task
+                if (blockStart >= firstMarker.load(std::memory_order_relaxed))
+                    return;
+
+                const auto blockLength = std::min(blockSize, chunkEnd - blockStart) + sequenceLength - 1;
+                size_t blockPosition = 0;
+                if (!FindPositionOfPacketMarker(line.substr(blockStart, blockLength), sequenceLength, blockPosition))
+                    continue;
+
+                // Chunks finish out of order, only ever keep the earliest marker
+                const auto marker = blockStart + blockPosition;
+                auto current = firstMarker.load(std::memory_order_relaxed);
+                while (marker < current && !firstMarker.compare_exchange_weak(current, marker, std::memory_order_relaxed))
+                {
+                }
+
+                break;
+            }
+        }
+    };
 
-    const uint32_t sequenceLengthPart1 = 4;
-    const uint32_t sequenceLengthPart2 = 14;
-    const auto positionPart1 = FindPositionOfPacketMarker(inputLine, sequenceLengthPart1);
-    const auto positionPart2 = FindPositionOfPacketMarker(inputLine, sequenceLengthPart2);
+    for (size_t i = 0; i < std::min(pool.GetNumThreads(), numChunks); ++i)
+    {
+        pool.Submit(scanChunks);
+    }
 
-    std::cout << "Part 1:" << std::endl;
-    std::cout << positionPart1 << std::endl;
-    std::cout << "Part 2:" << std::endl;
-    std::cout << positionPart2 << std::endl;
+    pool.Wait();
+    if (firstMarker.load() == std::string_view::npos)
+        return false;
+
+    position = firstMarker.load();
+    return true;
 }
 
-int main()
+// Finds the first marker of every one of the lengths in a single pass, so the cost doesn't
+// depend on how many lengths are asked for. At every position it keeps how long the run of
+// distinct bytes ending there is, and a window of length k ending there is a marker exactly
+// when that run is at least k. The run only grows one byte per step, so the first markers come
+// in order of length and each position only has to look at the shortest length not found yet.
+// A length without a marker gets npos.
+void FindPositionsOfPacketMarkers(
+    std::string_view line,
+    const std::vector<uint32_t>& sequenceLengths,
+    std::vector<size_t>& positions /* out */)
 {
-    Exercise6();
-}
\ No newline at end of file
+    positions.assign(sequenceLengths.size(), std::string_view::npos);
+
+    std::vector<size_t> byLength(sequenceLengths.size());
+    for (size_t i = 0; i < byLength.size(); ++i)
+    {
+        byLength[i] = i;
+    }
+
+    std::sort(byLength.begin(), byLength.end(), [&sequenceLengths](const size_t lhs, const size_t rhs)
+    {
+        return sequenceLengths[lhs] < sequenceLengths[rhs];
+    });
+
+    // A length of 0 never has a marker
+    auto next = std::find_if(byLength.begin(), byLength.end(), [&sequenceLengths](const size_t index)
+    {
+        return sequenceLengths[index] > 0;
+    });
+
+    // One past where every byte value was last seen, 0 for not seen yet
+    size_t lastSeen[256] = {};
+    size_t runStart = 0;
+    for (size_t i = 0; i < line.length() && next != byLength.end(); ++i)
+    {
+        auto& seen = lastSeen[static_cast<unsigned char>(line[i])];
+        runStart = std::max(runStart, seen);
+        seen = i + 1;
+
+        const auto runLength = i + 1 - runStart;
+        while (next != byLength.end() && sequenceLengths[*next] <= runLength)
+        {
+            positions[*next] = i + 1;
+            ++next;
+        }
+    }
+}
+
+// Empty if there is no marker. Uses the pool if there is one.
+const std::string PacketMarkerAnswer(
+    std::string_view line,
+    const uint32_t sequenceLength,
+    AdventOfCodeUtils::ThreadPool* pool)
+{
+    size_t position = 0;
+    const auto found = pool
+        ? FindPositionOfPacketMarkerParallel(line, sequenceLength, *pool, position)
+        : FindPositionOfPacketMarker(line, sequenceLength, position);
+    if (!found)
+        return "";
+
+    return std::to_string(position);
+}
+
+const uint32_t sequenceLengthPart1 = 4;
+const uint32_t sequenceLengthPart2 = 14;
+
+// Feeds the stream to a detector for each part, straight from anything that hands out the
+// bytes with NextBytes. Stops reading as soon as both markers are found, the stream ends at
+// the first newline.
+template<typename ByteSource>
+AdventOfCodeUtils::Answers DetectPacketMarkers(ByteSource& source)
+{
+    PacketMarkerDetector detectorPart1(sequenceLengthPart1);
+    PacketMarkerDetector detectorPart2(sequenceLengthPart2);
+    size_t positionPart1 = 0;
+    size_t positionPart2 = 0;
+    bool foundPart1 = false;
+    bool foundPart2 = false;
+
+    std::string_view bytes;
+    while (!(foundPart1 && foundPart2) && source.NextBytes(bytes))
+    {
+        const auto newline = bytes.find('\n');
+        foundPart1 = detectorPart1.Feed(bytes.substr(0, newline), positionPart1);
+        foundPart2 = detectorPart2.Feed(bytes.substr(0, newline), positionPart2);
+        if (newline != std::string_view::npos)
+            break;
+    }
+
+    return {
+        foundPart1 ? std::to_string(positionPart1) : "",
+        foundPart2 ? std::to_string(positionPart2) : "" };
+}
+
+class Solver : public AdventOfCodeUtils::StreamingExerciseSolver
+{
+public:
+    // parallel splits the stream between the cores, for streams of many megabytes. The pool
+    // lives as long as the solver, so solving again doesn't start new threads.
+    Solver(const bool parallel = false)
+    {
+        if (parallel)
+            m_pool = std::make_unique<AdventOfCodeUtils::ThreadPool>();
+    }
+
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise6";
+    }
+
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_6.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& inputFile) override
+    {
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise6.build");
+        m_inputLine = inputFile[0];
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        return {
+            PacketMarkerAnswer(m_inputLine, sequenceLengthPart1, m_pool.get()),
+            PacketMarkerAnswer(m_inputLine, sequenceLengthPart2, m_pool.get()) };
+    }
+
+    AdventOfCodeUtils::Answers SolveStreaming(AdventOfCodeUtils::StreamingLineReader& reader) const override
+    {
+        return DetectPacketMarkers(reader);
+    }
+
+    // The first marker of every length, npos where there is none
+    const std::vector<size_t> FindAllPacketMarkers(const std::vector<uint32_t>& sequenceLengths) const
+    {
+        std::vector<size_t> positions;
+        FindPositionsOfPacketMarkers(m_inputLine, sequenceLengths, positions);
+        return positions;
+    }
+
+private:
+    std::unique_ptr<AdventOfCodeUtils::ThreadPool> m_pool;
+    std::string_view m_inputLine;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise6Solver()
+{
+    return std::make_unique<Exercise6::Solver>();
+}
+
+#ifndef ADVENT_OF_CODE_NO_MAIN
+int main(int argc, char** argv)
+{
+    // --parallel scans the stream on every core
+    const std::string_view option(argc > 1 ? argv[1] : "");
+    Exercise6::Solver solver(option == "--parallel");
+
+#ifdef ADVENT_OF_CODE_ZLIB
+    // --gzip <file> decompresses the stream on another thread while it's being scanned. Needs
+    // building with -DADVENT_OF_CODE_ZLIB and -lz.
+    if (option == "--gzip")
+    {
+        if (argc != 3)
+        {
+            std::cerr << "Usage: " << argv[0] << " --gzip <file>" << std::endl;
+            return 1;
+        }
+
+        AdventOfCodeUtils::DecompressingReader reader(argv[2]);
+        if (!reader.IsOpen())
+        {
+            std::cerr << "Unable to open " << argv[2] << std::endl;
+            return 1;
+        }
+
+        const auto answers = Exercise6::DetectPacketMarkers(reader);
+        if (reader.HasFailed())
+        {
+            std::cerr << argv[2] << " is corrupt" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Part 1:" << std::endl << answers.part1 << std::endl;
+        std::cout << "Part 2:" << std::endl << answers.part2 << std::endl;
+        return 0;
+    }
+#endif
+
+    // --lengths <min> <max> prints the first marker of every length from min to max
+    if (option == "--lengths")
+    {
+        uint32_t minLength;
+        uint32_t maxLength;
+        if (argc != 4 ||
+            !AdventOfCodeUtils::ParseInteger(argv[2], minLength) ||
+            !AdventOfCodeUtils::ParseInteger(argv[3], maxLength) ||
+            minLength > maxLength)
+        {
+            std::cerr << "Usage: " << argv[0] << " --lengths <min> <max>" << std::endl;
+            return 1;
+        }
+
+        const AdventOfCodeUtils::MappedTextFile lines(solver.GetInputFilename());
+        if (!lines.IsOpen())
+        {
+            std::cerr << "Unable to open " << solver.GetInputFilename() << std::endl;
+            return 1;
+        }
+
+        solver.Parse(lines);
+        std::vector<uint32_t> sequenceLengths;
+        for (auto length = minLength; length <= maxLength; ++length)
+        {
+            sequenceLengths.push_back(length);
+        }
+
+        const auto positions = solver.FindAllPacketMarkers(sequenceLengths);
+        for (size_t i = 0; i < sequenceLengths.size(); ++i)
+        {
+            std::cout << sequenceLengths[i] << ": ";
+            if (positions[i] == std::string_view::npos)
+                std::cout << "none" << std::endl;
+            else
+                std::cout << positions[i] << std::endl;
+        }
+
+        return 0;
+    }
+
+    return AdventOfCodeUtils::RunExercise(solver, argc, argv);
+}
+#endif
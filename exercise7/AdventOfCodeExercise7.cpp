@@ -1,244 +1,211 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <algorithm>
 #include <assert.h>
 #include <stdint.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise7
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
 const char commandDelimiter = ' ';
 
-class FileSystemNode;
-class DirNode;
-class FileNode;
-
-class NodeVisitor
+// Gives every distinct directory name a number, so finding a subdirectory compares integers
+// rather than strings. Names are views into the input file, which outlives the parse.
+class NameTable
 {
 public:
-    NodeVisitor(std::shared_ptr<const DirNode> root)
-        : m_root(root) {}
-    
-    virtual ~NodeVisitor() = default;
+    NameTable() = default;
+    ~NameTable() = default;
 
-    void Visit();
-
-    virtual void VisitDir(const DirNode& dir) = 0;
-    virtual void VisitFile(const FileNode& fileNode) = 0;
-private:
-    std::shared_ptr<const DirNode> m_root;
-};
-
-class FileSystemNode
-{
-public:
-    FileSystemNode(const std::string name, std::shared_ptr<DirNode> parent)
-        : m_name(name)
-        , m_parent(parent)
-    {}
-        
-    virtual ~FileSystemNode() {};
-
-    virtual void Accept(NodeVisitor& c) const = 0;
-
-    const std::string& GetName() const
+    uint32_t Intern(std::string_view name)
     {
-        return m_name;
+        return m_indices.emplace(name, static_cast<uint32_t>(m_indices.size())).first->second;
     }
 
-    std::shared_ptr<const DirNode> GetParent() const
+    void Clear()
     {
-        return m_parent;
+        m_indices.clear();
     }
 
 private:
-    const std::string m_name;
-    std::shared_ptr<DirNode> m_parent;
+    std::unordered_map<std::string_view, uint32_t> m_indices;
 };
 
-class DirNode : public FileSystemNode
+// The tree is a set of parallel arrays indexed by node, with the root at index 0. A node is
+// always added after its parent, so a parent's index is smaller than any of its children's.
+// Directories are also linked into their parent's list of children through the first child
+// and next sibling columns, which is what "cd" walks. Files only need their parent and size,
+// so they stay out of those lists and have no name.
+class FileSystemTree
 {
 public:
-    DirNode(const std::string name, std::shared_ptr<DirNode> parent)
-        : FileSystemNode(name, parent)
-        , m_parent(parent) {}
-
-    ~DirNode() = default;
+    static constexpr uint32_t noNode = UINT32_MAX;
+    static constexpr uint32_t rootNode = 0;
 
-    void Accept(NodeVisitor& c) const override
+    FileSystemTree()
     {
-        c.VisitDir(*this);
+        Reset();
     }
 
-    void InsertFileOrSubdirecory(
-        const std::string& name, std::shared_ptr<FileSystemNode> fileOrSubdirectory)
+    ~FileSystemTree() = default;
+
+    // Leaves just the root
+    void Reset()
     {
-        m_contents[name] = fileOrSubdirectory;
+        m_parents.assign(1, noNode);
+        m_sizes.assign(1, 0);
+        m_flags.assign(1, isDirectoryFlag);
+        m_firstChildren.assign(1, noNode);
+        m_nextSiblings.assign(1, noNode);
+        m_names.assign(1, noName);
     }
 
-    const std::unordered_map<std::string, std::shared_ptr<FileSystemNode> >& GetContents() const
+    void Reserve(const size_t numNodes)
     {
-        return m_contents;
+        m_parents.reserve(numNodes);
+        m_sizes.reserve(numNodes);
+        m_flags.reserve(numNodes);
+        m_firstChildren.reserve(numNodes);
+        m_nextSiblings.reserve(numNodes);
+        m_names.reserve(numNodes);
     }
 
-    std::shared_ptr<DirNode> GetParent() const
+    uint32_t AddDirectory(const uint32_t parent, const uint32_t name)
     {
-        return m_parent;
+        const auto node = AddNode(parent, 0, isDirectoryFlag, name);
+        m_nextSiblings[node] = m_firstChildren[parent];
+        m_firstChildren[parent] = node;
+        return node;
     }
 
-private:
-    std::unordered_map<std::string, std::shared_ptr<FileSystemNode> > m_contents;
-    std::shared_ptr<DirNode> m_parent;
-};
+    uint32_t AddFile(const uint32_t parent, const uint32_t size)
+    {
+        return AddNode(parent, size, 0, noName);
+    }
 
-class FileNode : public FileSystemNode
-{
-public:
-    FileNode(const std::string& filename, std::shared_ptr<DirNode> parent, const uint32_t size)
-        : FileSystemNode(filename, parent) 
-        , m_size(size)
-    {}
+    // Returns noNode if the directory has no subdirectory with that name
+    uint32_t FindSubdirectory(const uint32_t directory, const uint32_t name) const
+    {
+        for (auto child = m_firstChildren[directory]; child != noNode; child = m_nextSiblings[child])
+        {
+            if (m_names[child] == name)
+                return child;
+        }
 
-    ~FileNode() = default;
+        return noNode;
+    }
 
-    void Accept(NodeVisitor& c) const override
+    // Whether the contents of a directory have already been added
+    bool IsListed(const uint32_t directory) const
     {
-        c.VisitFile(*this);
+        return (m_flags[directory] & isListedFlag) != 0;
     }
 
-    const uint32_t GetSize() const
+    void MarkListed(const uint32_t directory)
     {
-        return m_size;
+        m_flags[directory] |= isListedFlag;
     }
 
-private:
-    const uint32_t m_size;
-};
-
-void NodeVisitor::Visit()
-{
-    m_root->Accept(*this);
-}
-
-class FileSystemNodeFactory
-{
-public:
-    FileSystemNodeFactory() = default;
-    ~FileSystemNodeFactory() = default;
-
-    static std::shared_ptr<FileSystemNode> Create(
-        const std::string& input, std::shared_ptr<DirNode> parent)
+    bool IsDirectory(const uint32_t node) const
     {
-        const auto inputStrings = Split(input, ' ');
-
-        assert(inputStrings.size() == 2);
+        return (m_flags[node] & isDirectoryFlag) != 0;
+    }
 
-        if (inputStrings[0] == "dir")
-        {   
-            std::string fullyQualifiedPath = parent->GetName() + inputStrings[1] + "/";
-            return std::make_shared<DirNode>(fullyQualifiedPath, parent);
-        }
-        else
-        {
-            const auto fileSize = std::stoi(inputStrings[0]);
-            return std::make_shared<FileNode>(inputStrings[1], parent, fileSize);
-        }
+    uint32_t GetParent(const uint32_t node) const
+    {
+        return m_parents[node];
     }
-};
 
-class DirectorySizeComputer : public NodeVisitor
-{
-public:
-    static std::unordered_map<std::string, uint32_t> ComputeDirectoriesAndSizes(
-        std::shared_ptr<const DirNode> root)
+    // Zero for directories
+    uint32_t GetSize(const uint32_t node) const
     {
-        DirectorySizeComputer computer(root);
-        computer.Visit();
+        return m_sizes[node];
+    }
 
-        return computer.GetDirectoriesAndSizes();
+    uint32_t GetNumNodes() const
+    {
+        return static_cast<uint32_t>(m_parents.size());
     }
 
 private:
-    DirectorySizeComputer(std::shared_ptr<const DirNode> root)
-        : NodeVisitor(root) {}
+    static constexpr uint8_t isDirectoryFlag = 1;
+    static constexpr uint8_t isListedFlag = 2;
+    static constexpr uint32_t noName = UINT32_MAX;
+
+    uint32_t AddNode(const uint32_t parent, const uint32_t size, const uint8_t flags, const uint32_t name)
+    {
+        assert(parent < GetNumNodes() && IsDirectory(parent));
+        assert(GetNumNodes() < noNode);
+        const auto node = GetNumNodes();
+        m_parents.push_back(parent);
+        m_sizes.push_back(size);
+        m_flags.push_back(flags);
+        m_firstChildren.push_back(noNode);
+        m_nextSiblings.push_back(noNode);
+        m_names.push_back(name);
+        return node;
+    }
 
-    ~DirectorySizeComputer() = default;
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_sizes;
+    std::vector<uint8_t> m_flags;
+    std::vector<uint32_t> m_firstChildren;
+    std::vector<uint32_t> m_nextSiblings;
+    std::vector<uint32_t> m_names;
+};
 
-    void VisitDir(const DirNode& n) override
+class DirectorySizeComputer
+{
+public:
+    // Indexed by node. A directory gets the total of everything under it and a file its own
+    // size.
+    static std::vector<uint32_t> ComputeDirectorySizes(const FileSystemTree& tree)
     {
-        for (const auto& fileOrDir : n.GetContents())
+        const auto numNodes = tree.GetNumNodes();
+        std::vector<uint32_t> sizes(numNodes);
+        for (uint32_t node = 0; node < numNodes; ++node)
         {
-            fileOrDir.second->Accept(*this);
+            sizes[node] = tree.GetSize(node);
         }
-    }
 
-    void VisitFile(const FileNode& n) override
-    {   
-        auto parentDir = n.GetParent();
-        const auto fileSize = n.GetSize();
-        while (parentDir)
+        // Children come after their parents, so walking backwards finishes every node before
+        // its total goes up to its parent
+        for (auto node = numNodes - 1; node > FileSystemTree::rootNode; --node)
         {
-            m_directorySizes[parentDir->GetName()] += fileSize;
-            parentDir = parentDir->GetParent();
+            sizes[tree.GetParent(node)] += sizes[node];
         }
-    }
 
-    const std::unordered_map<std::string, uint32_t>& GetDirectoriesAndSizes() const
-    {
-        return m_directorySizes;
+        return sizes;
     }
-
-private:
-    std::unordered_map<std::string, uint32_t> m_directorySizes;
 };
 
+// Views into the input file, which outlives the parse
 struct CommandInOut
 {
-    std::string input;
-    std::vector<std::string> output;
+    std::string_view input;
+    std::vector<std::string_view> output;
 };
 
 class CommandParser
 {
 public:
-    CommandParser() = default;
+    CommandParser(FileSystemTree& tree, NameTable& names)
+        : m_tree(tree)
+        , m_names(names)
+        , m_currentDirectory(FileSystemTree::rootNode)
+    {}
+
     ~CommandParser() = default;
 
     void VisitCommand(
-        const std::string& command, const CommandInOut& inOut)
+        std::string_view command, const CommandInOut& inOut)
     {
         if (command == "cd")
         {
@@ -258,125 +225,172 @@ public:
     {
         if (inOut.input == "/")
         {
-            if (!m_rootNode)
-                m_rootNode = std::make_shared<DirNode>(inOut.input, m_rootNode);
-
-            m_currentDirectory = m_rootNode;
+            m_currentDirectory = FileSystemTree::rootNode;
         }
         else if (inOut.input == "..")
         {
-            const auto parentNode = m_currentDirectory->GetParent();
-            if (parentNode)
+            const auto parentNode = m_tree.GetParent(m_currentDirectory);
+            if (parentNode != FileSystemTree::noNode)
                 m_currentDirectory = parentNode;
         }
         else
         {
-            const auto& contents = m_currentDirectory->GetContents();
-
-            std::string fullyQualifiedName = m_currentDirectory->GetName() + inOut.input + "/";
-            const auto itr = contents.find(fullyQualifiedName);
-            assert(itr != contents.end());
-            m_currentDirectory = std::dynamic_pointer_cast<DirNode>(itr->second);
+            const auto subdirectory = m_tree.FindSubdirectory(m_currentDirectory, m_names.Intern(inOut.input));
+            assert(subdirectory != FileSystemTree::noNode);
+            m_currentDirectory = subdirectory;
         }
     }
 
     void VisitList(const CommandInOut& inOut)
     {
-        assert(m_currentDirectory);
-        const auto factory = FileSystemNodeFactory();
+        // Listing a directory again doesn't add anything new
+        if (m_tree.IsListed(m_currentDirectory))
+            return;
+
+        m_tree.MarkListed(m_currentDirectory);
         for (const auto& listItem : inOut.output)
         {
-            const auto node = factory.Create(listItem, m_currentDirectory);
-            m_currentDirectory->InsertFileOrSubdirecory(node->GetName(), node);
+            // "dir <name>" or "<size> <name>"
+            AdventOfCodeUtils::Tokenizer tokenizer(listItem, commandDelimiter);
+            std::string_view sizeOrDir;
+            std::string_view name;
+            const auto hasBothTokens = tokenizer.Next(sizeOrDir) && tokenizer.Next(name);
+            assert(hasBothTokens);
+
+            if (sizeOrDir == "dir")
+            {
+                m_tree.AddDirectory(m_currentDirectory, m_names.Intern(name));
+            }
+            else
+            {
+                uint32_t fileSize = 0;
+                const auto parsed = AdventOfCodeUtils::ParseInteger(sizeOrDir, fileSize);
+                assert(parsed);
+                m_tree.AddFile(m_currentDirectory, fileSize);
+            }
         }
     }
 
-    std::shared_ptr<const DirNode> GetRoot() const
-    {
-        return m_rootNode;
-    }
-
 private:
-    std::shared_ptr<DirNode> m_rootNode;
-    std::shared_ptr<DirNode> m_currentDirectory;
+    FileSystemTree& m_tree;
+    NameTable& m_names;
+    uint32_t m_currentDirectory;
 };
 
-void AdventOfCodeExercise7()
+class Solver : public AdventOfCodeUtils::ExerciseSolver
 {
-    const auto lines = ReadTextFile("input_exercise_7.txt");
-    CommandParser commandParser;
-    CommandInOut inOut;
-    std::string currentCommandName;
-    for (auto i = 0; i < lines.size(); ++i)
+public:
+    Solver() = default;
+    ~Solver() = default;
+
+    const char* GetName() const override
     {
-        const auto tokens = Split(lines[i], commandDelimiter);
-        assert(tokens.size() > 0);
+        return "exercise7";
+    }
 
-        if (tokens[0] == "$")
-        {
-            // Processing a command
-            currentCommandName = tokens[1];
-            if (tokens.size() > 2)
-                inOut.input = tokens[2];
-        }
-        else
-        {
-            // Processing command output
-            inOut.output.push_back(lines[i]);
-        }
-        
-        const auto nextLine = lines[i+1];
-        if (nextLine.empty())
-        {
-            commandParser.VisitCommand(currentCommandName, inOut);
-            break;
-        }
+    const char* GetInputFilename() const override
+    {
+        return "input_exercise_7.txt";
+    }
 
-        const auto nextLineStrings = Split(nextLine, commandDelimiter);
-        if (nextLineStrings[0] == "$")
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        // The directory tree is built while the terminal output is parsed
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise7.build");
+        // Every node comes from its own line of "ls" output, plus the root
+        m_tree.Reset();
+        m_tree.Reserve(lines.size() + 1);
+        m_names.Clear();
+        CommandParser commandParser(m_tree, m_names);
+        CommandInOut inOut;
+        std::string_view currentCommandName;
+        for (size_t i = 0; i < lines.size(); ++i)
         {
-            // We've reached the next command, so we have the input and output
-            // for the current command. Visit it!
-            commandParser.VisitCommand(currentCommandName, inOut);
-            currentCommandName.clear();
-            inOut.input.clear();
-            inOut.output.clear();
+            AdventOfCodeUtils::Tokenizer tokenizer(lines[i], commandDelimiter);
+            std::string_view firstToken;
+            const auto hasFirstToken = tokenizer.Next(firstToken);
+            assert(hasFirstToken);
+
+            if (firstToken == "$")
+            {
+                // Processing a command
+                tokenizer.Next(currentCommandName);
+                tokenizer.Next(inOut.input);
+            }
+            else
+            {
+                // Processing command output
+                inOut.output.push_back(lines[i]);
+            }
+            
+            const auto isLastLine = i + 1 == lines.size();
+            if (isLastLine || lines[i+1].empty())
+            {
+                commandParser.VisitCommand(currentCommandName, inOut);
+                break;
+            }
+
+            std::string_view nextLineFirstToken;
+            AdventOfCodeUtils::Tokenizer(lines[i+1], commandDelimiter).Next(nextLineFirstToken);
+            if (nextLineFirstToken == "$")
+            {
+                // We've reached the next command, so we have the input and output
+                // for the current command. Visit it!
+                commandParser.VisitCommand(currentCommandName, inOut);
+                currentCommandName = std::string_view();
+                inOut.input = std::string_view();
+                inOut.output.clear();
+            }
         }
     }
 
-    const auto thresholdPart1 = 100000;
-    auto totalPart1 = 0;
-
-    uint32_t totalPart2 = UINT32_MAX;
-    const auto totalDiskSpace = 70000000;
-    const auto neededDiskSpace = 30000000;
-    const auto& directoriesAndSizes = 
-            DirectorySizeComputer::ComputeDirectoriesAndSizes(commandParser.GetRoot());
-
-    const auto rootDir = directoriesAndSizes.find("/");
-    assert(rootDir != directoriesAndSizes.end());
-    const auto unusedSpace = totalDiskSpace - rootDir->second;
-    const auto thresholdPart2 = neededDiskSpace - unusedSpace;
-    
-    for (const auto& directory : directoriesAndSizes)
+    AdventOfCodeUtils::Answers Solve() const override
     {
-        if (directory.second <= thresholdPart1)
-        {
-            totalPart1 += directory.second;
-        }
+        const auto thresholdPart1 = 100000;
+        uint64_t totalPart1 = 0;
+
+        uint32_t totalPart2 = UINT32_MAX;
+        const auto totalDiskSpace = 70000000;
+        const auto neededDiskSpace = 30000000;
+        const auto sizes = DirectorySizeComputer::ComputeDirectorySizes(m_tree);
 
-        if (directory.second >= thresholdPart2)
+        const auto unusedSpace = totalDiskSpace - sizes[FileSystemTree::rootNode];
+        const auto thresholdPart2 = neededDiskSpace - unusedSpace;
+        
+        for (uint32_t node = 0; node < sizes.size(); ++node)
         {
-            totalPart2 = std::min(totalPart2, directory.second);
+            if (!m_tree.IsDirectory(node))
+                continue;
+
+            if (sizes[node] <= thresholdPart1)
+            {
+                totalPart1 += sizes[node];
+            }
+
+            if (sizes[node] >= thresholdPart2)
+            {
+                totalPart2 = std::min(totalPart2, sizes[node]);
+            }
         }
 
+        return { std::to_string(totalPart1), std::to_string(totalPart2) };
     }
 
-    std::cout << totalPart1 << std::endl;
-    std::cout << totalPart2 << std::endl;
+private:
+    FileSystemTree m_tree;
+    NameTable m_names;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise7Solver()
+{
+    return std::make_unique<Exercise7::Solver>();
 }
 
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise7();
-}
\ No newline at end of file
+    Exercise7::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
+}
+#endif
@@ -1,61 +1,41 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <assert.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise8
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
 class TreeMatrix
 {
 public:
-    TreeMatrix(const uint32_t numRows)
+    TreeMatrix(const uint32_t numRows = 0)
     {
         m_rows.reserve(numRows);
     }
 
     ~TreeMatrix() = default;
 
-    void InsertRow(const std::string& row)
+    void InsertRow(std::string_view row)
     {
         std::vector<uint32_t> values;
 
         const auto numCols = row.size();
-        m_cols.reserve(numCols);
+        if (m_cols.size() < numCols)
+            m_cols.resize(numCols);
+
         values.reserve(numCols);
         for (auto columnNumber = 0; columnNumber < numCols; ++columnNumber)
         {
-            const uint32_t v = std::stoi(row.substr(columnNumber, 1));
+            // Every tree is a single digit
+            assert(row[columnNumber] >= '0' && row[columnNumber] <= '9');
+            const uint32_t v = row[columnNumber] - '0';
             values.push_back(v);
-            if (m_cols[columnNumber].empty())
-            {
-                std::vector<uint32_t> newCol;
-                newCol.push_back(v);
-                m_cols.push_back(newCol);
-            }
-            else
-            {
-                m_cols[columnNumber].push_back(v);
-            }
+            m_cols[columnNumber].push_back(v);
         }
 
         m_rows.push_back(values);
@@ -142,40 +122,74 @@ std::pair<bool, uint32_t> CheckVisible(
         visibleAndScenicScoreAlongColumn.first || visibleAndScenicScoreAlongRow.first, scenicScoreTotal);
 }
 
-void AdventOfCodeExercise8()
+class Solver : public AdventOfCodeUtils::ExerciseSolver
 {
-    const auto lines = ReadTextFile("input_exercise_8.txt");
-    const auto numRows = lines.size();
-    assert(lines.size() > 0);
+public:
+    Solver() = default;
+    ~Solver() = default;
 
-    const auto numCols = lines[0].size();
-    TreeMatrix matrix(numRows);
-    for (auto i = 0; i < lines.size(); ++i)
+    const char* GetName() const override
     {
-        matrix.InsertRow(lines[i]);
+        return "exercise8";
     }
-    
-    uint32_t totalPart1 = 0;
-    uint32_t totalPart2 = 0;
-    for (auto i = 0; i < numRows; ++i)
+
+    const char* GetInputFilename() const override
     {
-        for (auto j = 0; j < numCols; ++j)
+        return "input_exercise_8.txt";
+    }
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        m_numRows = lines.size();
+        assert(lines.size() > 0);
+
+        m_numCols = lines[0].size();
+
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise8.build");
+        m_matrix = TreeMatrix(m_numRows);
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            m_matrix.InsertRow(lines[i]);
+        }
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        uint32_t totalPart1 = 0;
+        uint32_t totalPart2 = 0;
+        for (auto i = 0; i < m_numRows; ++i)
         {
-            const auto visibleAndScenicScore = CheckVisible(matrix, i, j);
-            if (visibleAndScenicScore.first)
+            for (auto j = 0; j < m_numCols; ++j)
             {
-                totalPart1++;
-            }
+                const auto visibleAndScenicScore = CheckVisible(m_matrix, i, j);
+                if (visibleAndScenicScore.first)
+                {
+                    totalPart1++;
+                }
 
-            totalPart2 = std::max(totalPart2, visibleAndScenicScore.second);
+                totalPart2 = std::max(totalPart2, visibleAndScenicScore.second);
+            }
         }
+
+        return { std::to_string(totalPart1), std::to_string(totalPart2) };
     }
 
-    std::cout << totalPart1 << std::endl;
-    std::cout << totalPart2 << std::endl;
+private:
+    TreeMatrix m_matrix;
+    uint32_t m_numRows;
+    uint32_t m_numCols;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise8Solver()
+{
+    return std::make_unique<Exercise8::Solver>();
 }
 
+#ifndef ADVENT_OF_CODE_NO_MAIN
 int main()
 {
-    AdventOfCodeExercise8();
+    Exercise8::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver);
 }
+#endif
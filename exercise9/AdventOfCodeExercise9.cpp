@@ -1,45 +1,17 @@
 #include <iostream>
-#include <sstream>
-#include <fstream>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 #include <assert.h>
 #include <math.h>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeInstrumentation.h"
+#include "../AdventOfCodeExercises.h"
 
-std::vector<std::string> ReadTextFile(std::string inputFilename)
+namespace Exercise9
 {
-    std::ifstream myfile;
-    std::string line;
-
-    std::vector<std::string> output;
-    myfile.open(inputFilename);
-    if (myfile.is_open())
-    {
-        while (getline(myfile,line))
-        {
-            output.push_back(std::string(line));
-        }
-
-        myfile.close();
-    }
-    return output;
-}
-
-std::vector<std::string> Split(const std::string& input, const char& commandDelimiter)
-{
-    std::vector<std::string> strings;
-    std::istringstream f(input);
-    std::string s;
-    while(std::getline(f, s, commandDelimiter))
-    {
-        strings.push_back(s);
-    }
-
-    return strings;
-}
-
 enum Direction
 {
     Up,
@@ -247,7 +219,7 @@ private:
     std::set<std::pair<int, int> > m_visited;
 };
 
-const Direction StringToDirection(const std::string& s)
+const Direction StringToDirection(std::string_view s)
 {
     Direction d;
         if (s == "D")
@@ -264,27 +236,97 @@ const Direction StringToDirection(const std::string& s)
     return d;
 }
 
-void AdventOfCodeExercise9()
+struct RopeMove
+{
+    Direction direction;
+    uint32_t steps;
+};
+
+RopeMove BuildMoveFromLine(std::string_view line)
+{
+    AdventOfCodeUtils::Tokenizer tokenizer(line);
+    std::string_view directionStr;
+    std::string_view stepsStr;
+    tokenizer.Next(directionStr);
+    tokenizer.Next(stepsStr);
+
+    const auto direction = StringToDirection(directionStr);
+    uint32_t steps = 0;
+    const auto parsed = AdventOfCodeUtils::ParseInteger(stepsStr, steps);
+    assert(parsed);
+    return { direction, steps };
+}
+
+class Solver : public AdventOfCodeUtils::StreamingExerciseSolver
 {
-    const auto lines = ReadTextFile("input_exercise_9.txt");
+public:
+    Solver() = default;
+    ~Solver() = default;
+
+    const char* GetName() const override
+    {
+        return "exercise9";
+    }
 
-    Rope rPart1(2);
-    Rope rPart2(10);
-    std::set<std::pair<int,int> > visited;
-    for (const auto& line : lines)
+    const char* GetInputFilename() const override
     {
-        const auto strings = Split(line, ' ');
-        const auto direction = StringToDirection(strings[0]);
-        const auto steps = std::stoi(strings[1]);
-        rPart1.Move(direction, steps);
-        rPart2.Move(direction, steps);
+        return "input_exercise_9.txt";
     }
-    
-    std::cout << rPart1.GetVisited().size() << std::endl;
-    std::cout << rPart2.GetVisited().size() << std::endl;
+
+    void Parse(const AdventOfCodeUtils::MappedTextFile& lines) override
+    {
+        ADVENT_OF_CODE_SCOPED_TIMER("exercise9.build");
+        m_moves.clear();
+        m_moves.reserve(lines.size());
+        for (const auto& line : lines)
+        {
+            m_moves.push_back(BuildMoveFromLine(line));
+        }
+    }
+
+    AdventOfCodeUtils::Answers Solve() const override
+    {
+        Rope rPart1(2);
+        Rope rPart2(10);
+        for (const auto& move : m_moves)
+        {
+            rPart1.Move(move.direction, move.steps);
+            rPart2.Move(move.direction, move.steps);
+        }
+
+        return { std::to_string(rPart1.GetVisited().size()), std::to_string(rPart2.GetVisited().size()) };
+    }
+
+    AdventOfCodeUtils::Answers SolveStreaming(AdventOfCodeUtils::StreamingLineReader& reader) const override
+    {
+        // Both ropes move as soon as each line arrives, so no moves are kept around
+        Rope rPart1(2);
+        Rope rPart2(10);
+        std::string_view line;
+        while (reader.NextLine(line))
+        {
+            const auto move = BuildMoveFromLine(line);
+            rPart1.Move(move.direction, move.steps);
+            rPart2.Move(move.direction, move.steps);
+        }
+
+        return { std::to_string(rPart1.GetVisited().size()), std::to_string(rPart2.GetVisited().size()) };
+    }
+
+private:
+    std::vector<RopeMove> m_moves;
+};
+}
+
+std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> AdventOfCodeExercises::CreateExercise9Solver()
+{
+    return std::make_unique<Exercise9::Solver>();
 }
 
-int main()
+#ifndef ADVENT_OF_CODE_NO_MAIN
+int main(int argc, char** argv)
 {
-    AdventOfCodeExercise9();
-}
\ No newline at end of file
+    Exercise9::Solver solver;
+    return AdventOfCodeUtils::RunExercise(solver, argc, argv);
+}
+#endif
@@ -0,0 +1,585 @@
+// Writes synthetic inputs of any size for the exercises, so the benchmark can be run on inputs
+// much larger than the puzzle inputs. The same exercise, size and seed always produce the same
+// input.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -o aoc_generator generator/AdventOfCodeGenerator.cpp
+//
+// Usage:
+//   aoc_generator <exercise> --size N [--width W] [--seed S] > input.txt
+//
+// What --size and --width mean depends on the exercise:
+//   exercise5   N move instructions over W stacks (default 9, at least 2)
+//   exercise6   a datastream of N bytes whose 14 byte marker is at the very end
+//   exercise7   a terminal log listing N files, at most W directories deep (default 8)
+//   exercise8   an N x W tree grid (W defaults to N)
+//   exercise9   N rope moves
+//   exercise10  N instructions
+//   exercise11  N monkeys
+//   exercise12  an N x W height map (W defaults to N, widened so that N + W is at least 27)
+//   exercise13  N packet pairs nested at most W lists deep (default 10)
+//   exercise14  N rock paths
+//   exercise15  N sensors
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct GeneratorOptions
+{
+    std::string exercise;
+    uint64_t size = 0;
+    uint64_t width = 0;
+    uint64_t seed = 2022;
+};
+
+typedef std::mt19937_64 Random;
+
+// Uniform integer in [min, max]
+int64_t Uniform(Random& random, const int64_t min, const int64_t max)
+{
+    return std::uniform_int_distribution<int64_t>(min, max)(random);
+}
+
+void GenerateExercise5(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const auto numStacks = options.width > 0 ? std::max<uint64_t>(options.width, 2) : 9;
+    const auto maxInitialHeight = 8 + options.size / (numStacks * 4);
+
+    std::vector<std::string> stacks(numStacks);
+    for (auto& stack : stacks)
+    {
+        const auto height = Uniform(random, 1, maxInitialHeight);
+        for (int64_t i = 0; i < height; ++i)
+            stack.push_back(static_cast<char>('A' + Uniform(random, 0, 25)));
+    }
+
+    // Moves need a stack with at least two crates, which there always is once there are more
+    // crates than stacks
+    if (std::all_of(stacks.begin(), stacks.end(), [](const std::string& stack) { return stack.size() == 1; }))
+        stacks[Uniform(random, 0, numStacks - 1)].push_back(static_cast<char>('A' + Uniform(random, 0, 25)));
+
+    // The drawing is top down with every row padded to the full width
+    size_t tallest = 0;
+    for (const auto& stack : stacks)
+        tallest = std::max(tallest, stack.size());
+
+    std::string row;
+    for (size_t level = tallest; level > 0; --level)
+    {
+        row.clear();
+        for (size_t s = 0; s < numStacks; ++s)
+        {
+            if (s > 0)
+                row.push_back(' ');
+
+            if (stacks[s].size() >= level)
+                row.append({ '[', stacks[s][level - 1], ']' });
+            else
+                row.append("   ");
+        }
+
+        output << row << '\n';
+    }
+
+    // The stack numbers are only skipped by the parser, so a single digit is enough
+    for (size_t s = 0; s < numStacks; ++s)
+        output << (s > 0 ? "   " : " ") << (s + 1) % 10;
+    output << " \n\n";
+
+    // Moves never empty a stack, so every stack still has a top crate at the end
+    std::vector<size_t> heights(numStacks);
+    for (size_t s = 0; s < numStacks; ++s)
+        heights[s] = stacks[s].size();
+
+    for (uint64_t i = 0; i < options.size; ++i)
+    {
+        size_t from = Uniform(random, 0, numStacks - 1);
+        while (heights[from] < 2)
+            from = (from + 1) % numStacks;
+
+        // Every so often a move goes from a stack onto itself, which leaves it as it was
+        size_t to = from;
+        if (Uniform(random, 0, 15) > 0)
+        {
+            to = Uniform(random, 0, numStacks - 2);
+            if (to >= from)
+                ++to;
+        }
+
+        const auto quantity = Uniform(random, 1, heights[from] - 1);
+        heights[from] -= quantity;
+        heights[to] += quantity;
+        output << "move " << quantity << " from " << from + 1 << " to " << to + 1 << '\n';
+    }
+}
+
+void GenerateExercise6(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const uint64_t markerLength = 14;
+    const auto length = std::max(options.size, markerLength + 1);
+
+    // Draw from 13 letters so that no 14 byte window is a marker until the final one. Both the
+    // marker and the byte before it are an 'a', so no window overlapping the marker matches early.
+    std::string stream;
+    stream.reserve(length);
+    for (uint64_t i = 0; i < length - markerLength - 1; ++i)
+        stream.push_back(static_cast<char>('a' + Uniform(random, 0, 12)));
+
+    std::string marker("nopqrstuvwxyz");
+    std::shuffle(marker.begin(), marker.end(), random);
+    stream.append("aa");
+    stream.append(marker);
+
+    output << stream << '\n';
+}
+
+struct GeneratedDirectory
+{
+    std::vector<uint32_t> fileSizes;
+    std::vector<size_t> subdirectories;
+};
+
+void EmitDirectory(
+    const std::vector<GeneratedDirectory>& directories, const size_t index, std::ostream& output)
+{
+    const auto& directory = directories[index];
+    output << "$ ls\n";
+    for (const auto subdirectory : directory.subdirectories)
+        output << "dir d" << subdirectory << '\n';
+
+    for (size_t f = 0; f < directory.fileSizes.size(); ++f)
+        output << directory.fileSizes[f] << " f" << f << ".txt\n";
+
+    for (const auto subdirectory : directory.subdirectories)
+    {
+        output << "$ cd d" << subdirectory << '\n';
+        EmitDirectory(directories, subdirectory, output);
+        output << "$ cd ..\n";
+    }
+}
+
+void GenerateExercise7(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const auto maxDepth = options.width > 0 ? options.width : 8;
+    const auto numFiles = std::max<uint64_t>(options.size, 1);
+
+    // Roughly eight files per directory
+    std::vector<GeneratedDirectory> directories(1);
+    std::vector<size_t> depths(1, 0);
+    const auto numDirectories = std::max<uint64_t>(1, numFiles / 8);
+    for (uint64_t d = 1; d < numDirectories; ++d)
+    {
+        size_t parent = Uniform(random, 0, directories.size() - 1);
+        while (depths[parent] >= maxDepth)
+            parent = Uniform(random, 0, directories.size() - 1);
+
+        directories[parent].subdirectories.push_back(directories.size());
+        depths.push_back(depths[parent] + 1);
+        directories.emplace_back();
+    }
+
+    // Fill the 70000000 disk to between 40000000 and 49000000, like the puzzle input, so part 2
+    // always has to free something and the total stays inside the solver's uint32_t. The total is
+    // split between the files by random weights, and files get size 0 once there are more files
+    // than bytes to share
+    const auto totalSize = static_cast<uint64_t>(Uniform(random, 40000001, 49000000));
+    std::vector<uint64_t> weights(numFiles);
+    uint64_t totalWeight = 0;
+    for (auto& weight : weights)
+    {
+        weight = Uniform(random, 1, 100);
+        totalWeight += weight;
+    }
+
+    uint64_t cumulativeWeight = 0;
+    uint64_t cumulativeSize = 0;
+    for (const auto weight : weights)
+    {
+        cumulativeWeight += weight;
+        const auto nextCumulativeSize = cumulativeWeight * totalSize / totalWeight;
+        const auto directory = Uniform(random, 0, directories.size() - 1);
+        directories[directory].fileSizes.push_back(static_cast<uint32_t>(nextCumulativeSize - cumulativeSize));
+        cumulativeSize = nextCumulativeSize;
+    }
+
+    output << "$ cd /\n";
+    EmitDirectory(directories, 0, output);
+}
+
+void GenerateExercise8(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const auto numCols = options.width > 0 ? options.width : options.size;
+
+    std::string row(numCols, '0');
+    for (uint64_t r = 0; r < options.size; ++r)
+    {
+        for (auto& tree : row)
+            tree = static_cast<char>('0' + Uniform(random, 0, 9));
+
+        output << row << '\n';
+    }
+}
+
+void GenerateExercise9(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const char directions[] = { 'U', 'D', 'L', 'R' };
+    for (uint64_t i = 0; i < options.size; ++i)
+        output << directions[Uniform(random, 0, 3)] << ' ' << Uniform(random, 1, 20) << '\n';
+}
+
+void GenerateExercise10(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    for (uint64_t i = 0; i < options.size; ++i)
+    {
+        if (Uniform(random, 0, 2) == 0)
+            output << "noop\n";
+        else
+            output << "addx " << Uniform(random, -20, 20) << '\n';
+    }
+}
+
+struct GeneratedMonkey
+{
+    std::vector<uint64_t> items;
+    // 0 is old * old, 1 is old * operand and 2 is old + operand
+    int64_t operation;
+    int64_t operand;
+    uint64_t divisor;
+    uint64_t ifTrue;
+    uint64_t ifFalse;
+};
+
+// Runs the 20 rounds of part 1 and returns every monkey whose operation takes a worry level
+// past maxWorryLevel. Part 1 never reduces the worry levels modulo anything, so they have to
+// fit as they are. An item that overflows is dropped, so the rest of the run carries on.
+std::vector<size_t> FindOverflowingMonkeys(const std::vector<GeneratedMonkey>& monkeys, const uint64_t maxWorryLevel)
+{
+    std::vector<size_t> overflowing;
+    std::vector<std::vector<uint64_t> > items;
+    for (const auto& monkey : monkeys)
+        items.push_back(monkey.items);
+
+    for (int round = 0; round < 20; ++round)
+    {
+        for (size_t m = 0; m < monkeys.size(); ++m)
+        {
+            const auto& monkey = monkeys[m];
+            for (const auto old : items[m])
+            {
+                const auto operand = monkey.operation == 0 ? old : static_cast<uint64_t>(monkey.operand);
+                if (monkey.operation == 2 ? old > maxWorryLevel - operand : operand != 0 && old > maxWorryLevel / operand)
+                {
+                    if (overflowing.empty() || overflowing.back() != m)
+                        overflowing.push_back(m);
+
+                    continue;
+                }
+
+                const auto worryLevel = (monkey.operation == 2 ? old + operand : old * operand) / 3;
+                items[worryLevel % monkey.divisor == 0 ? monkey.ifTrue : monkey.ifFalse].push_back(worryLevel);
+            }
+
+            items[m].clear();
+        }
+    }
+
+    return overflowing;
+}
+
+void GenerateExercise11(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    // The solver reduces part 2 worry levels modulo the least common multiple of the divisors,
+    // which for these is at most their product, about 1.1e8, so squaring stays inside 64 bits
+    const uint32_t divisors[] = { 3, 5, 7, 11, 13, 17, 19, 23 };
+    const auto numMonkeys = std::max<uint64_t>(options.size, 2);
+
+    std::vector<GeneratedMonkey> monkeys(numMonkeys);
+    for (uint64_t m = 0; m < numMonkeys; ++m)
+    {
+        auto& monkey = monkeys[m];
+        const auto numItems = Uniform(random, 1, 6);
+        for (int64_t i = 0; i < numItems; ++i)
+            monkey.items.push_back(Uniform(random, 50, 99));
+
+        monkey.operation = Uniform(random, 0, 2);
+        if (monkey.operation == 1)
+            monkey.operand = Uniform(random, 2, 19);
+        else if (monkey.operation == 2)
+            monkey.operand = Uniform(random, 1, 8);
+
+        monkey.divisor = divisors[Uniform(random, 0, 7)];
+
+        monkey.ifTrue = Uniform(random, 0, numMonkeys - 2);
+        if (monkey.ifTrue >= m)
+            ++monkey.ifTrue;
+
+        monkey.ifFalse = Uniform(random, 0, numMonkeys - 2);
+        if (monkey.ifFalse >= m)
+            ++monkey.ifFalse;
+    }
+
+    // Part 1 worry levels only ever get divided by 3, so a few multiplications in a row can
+    // outgrow any integer. Monkeys that would do that add instead, until part 1 fits in the
+    // solver's signed 64 bits.
+    const uint64_t maxWorryLevel = uint64_t(1) << 62;
+    auto overflowing = FindOverflowingMonkeys(monkeys, maxWorryLevel);
+    while (!overflowing.empty())
+    {
+        for (const auto m : overflowing)
+        {
+            monkeys[m].operation = 2;
+            monkeys[m].operand = Uniform(random, 1, 8);
+        }
+
+        overflowing = FindOverflowingMonkeys(monkeys, maxWorryLevel);
+    }
+
+    for (uint64_t m = 0; m < numMonkeys; ++m)
+    {
+        const auto& monkey = monkeys[m];
+        output << "Monkey " << m << ":\n";
+
+        output << "  Starting items: ";
+        for (size_t i = 0; i < monkey.items.size(); ++i)
+            output << (i > 0 ? ", " : "") << monkey.items[i];
+        output << '\n';
+
+        if (monkey.operation == 0)
+            output << "  Operation: new = old * old\n";
+        else if (monkey.operation == 1)
+            output << "  Operation: new = old * " << monkey.operand << '\n';
+        else
+            output << "  Operation: new = old + " << monkey.operand << '\n';
+
+        output << "  Test: divisible by " << monkey.divisor << '\n';
+        output << "    If true: throw to monkey " << monkey.ifTrue << '\n';
+        output << "    If false: throw to monkey " << monkey.ifFalse << '\n';
+
+        // The parser finishes a monkey on the blank line after it
+        output << '\n';
+    }
+}
+
+void GenerateExercise12(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    // The staircase below takes numRows + numCols - 2 steps and needs 25 of them to climb from
+    // 'a' to 'z' one letter at a time
+    const uint64_t minPathLength = 25;
+    const auto numRows = std::max<uint64_t>(options.size, 2);
+    const auto requestedCols = options.width > 0 ? options.width : numRows;
+    const auto numCols = std::max<uint64_t>(requestedCols, numRows < minPathLength + 2 ? minPathLength + 2 - numRows : 1);
+
+    std::vector<std::string> rows(numRows, std::string(numCols, 'a'));
+    for (auto& row : rows)
+    {
+        for (auto& cell : row)
+            cell = static_cast<char>('a' + Uniform(random, 0, 25));
+    }
+
+    // Carve a random staircase from S in the top left to E in the bottom right that never
+    // climbs by more than one, so there's always at least one valid hike
+    uint64_t r = 0;
+    uint64_t c = 0;
+    const auto pathLength = numRows + numCols - 2;
+    for (uint64_t step = 0; step <= pathLength; ++step)
+    {
+        rows[r][c] = static_cast<char>('a' + (25 * step) / pathLength);
+
+        const bool canGoDown = r + 1 < numRows;
+        const bool canGoRight = c + 1 < numCols;
+        if (canGoDown && (!canGoRight || Uniform(random, 0, 1) == 0))
+            ++r;
+        else if (canGoRight)
+            ++c;
+    }
+
+    rows[0][0] = 'S';
+    rows[numRows - 1][numCols - 1] = 'E';
+
+    for (const auto& row : rows)
+        output << row << '\n';
+}
+
+void GeneratePacket(Random& random, const uint64_t depthRemaining, std::string& packet)
+{
+    packet.push_back('[');
+    const auto numElements = Uniform(random, 0, 4);
+    for (int64_t i = 0; i < numElements; ++i)
+    {
+        if (i > 0)
+            packet.push_back(',');
+
+        if (depthRemaining > 0 && Uniform(random, 0, 2) == 0)
+            GeneratePacket(random, depthRemaining - 1, packet);
+        else
+            packet.append(std::to_string(Uniform(random, 0, 10)));
+    }
+    packet.push_back(']');
+}
+
+void GenerateExercise13(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    const auto maxDepth = options.width > 0 ? options.width : 10;
+
+    std::string packet;
+    for (uint64_t pair = 0; pair < options.size; ++pair)
+    {
+        if (pair > 0)
+            output << '\n';
+
+        for (int i = 0; i < 2; ++i)
+        {
+            packet.clear();
+            GeneratePacket(random, maxDepth, packet);
+            output << packet << '\n';
+        }
+    }
+}
+
+void GenerateExercise14(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    // Rocks spread sideways as the cave gets bigger, and always stay below the sand source
+    const int64_t spread = 20 + options.size / 4;
+    const int64_t maxDepth = 20 + options.size / 8;
+
+    for (uint64_t path = 0; path < options.size; ++path)
+    {
+        int64_t x = 500 + Uniform(random, -spread, spread);
+        int64_t y = Uniform(random, 2, maxDepth);
+        output << x << ',' << y;
+
+        // Every segment is horizontal or vertical and at least one tile long
+        const auto numSegments = Uniform(random, 1, 4);
+        for (int64_t s = 0; s < numSegments; ++s)
+        {
+            const auto length = Uniform(random, 1, 6);
+            if (s % 2 == 0)
+                x += Uniform(random, 0, 1) == 0 ? -length : length;
+            else
+            {
+                const bool goDown = Uniform(random, 0, 1) == 0 || y - length < 1;
+                y += goDown ? length : -length;
+            }
+
+            output << " -> " << x << ',' << y;
+        }
+
+        output << '\n';
+    }
+}
+
+void EmitSensor(const int64_t sx, const int64_t sy, const int64_t radius, std::ostream& output)
+{
+    output << "Sensor at x=" << sx << ", y=" << sy
+           << ": closest beacon is at x=" << sx + radius << ", y=" << sy << '\n';
+}
+
+void GenerateExercise15(const GeneratorOptions& options, Random& random, std::ostream& output)
+{
+    // Every sensor reaches to just short of a hidden beacon. Four of them sit beyond the corners
+    // of the search area so that the hidden beacon is the only uncovered point inside it.
+    const int64_t extent = 4000000;
+    const int64_t px = Uniform(random, 1, extent - 1);
+    int64_t py = Uniform(random, 1, extent - 1);
+    if (py == 2000000)
+        ++py;
+
+    const auto distanceToHidden = [px, py](const int64_t x, const int64_t y)
+    {
+        return std::abs(x - px) + std::abs(y - py);
+    };
+
+    const int64_t corners[4][2] = { { -1, -1 }, { extent + 1, -1 }, { -1, extent + 1 }, { extent + 1, extent + 1 } };
+    for (const auto& corner : corners)
+        EmitSensor(corner[0], corner[1], distanceToHidden(corner[0], corner[1]) - 1, output);
+
+    for (uint64_t i = 4; i < options.size; ++i)
+    {
+        const auto sx = Uniform(random, 0, extent);
+        const auto sy = Uniform(random, 0, extent);
+        const auto radius = distanceToHidden(sx, sy) - 1;
+        if (radius < 1)
+            continue;
+
+        EmitSensor(sx, sy, radius, output);
+    }
+}
+
+bool ParseOptions(int argc, char** argv, GeneratorOptions& options /* out */)
+{
+    if (argc < 2)
+        return false;
+
+    options.exercise = argv[1];
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        if (i + 1 >= argc)
+            return false;
+
+        const auto value = std::strtoull(argv[++i], nullptr, 10);
+        if (argument == "--size")
+            options.size = value;
+        else if (argument == "--width")
+            options.width = value;
+        else if (argument == "--seed")
+            options.seed = value;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    GeneratorOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0] << " <exercise> --size N [--width W] [--seed S]" << std::endl;
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+    Random random(options.seed);
+
+    if (options.exercise == "exercise5")
+        GenerateExercise5(options, random, std::cout);
+    else if (options.exercise == "exercise6")
+        GenerateExercise6(options, random, std::cout);
+    else if (options.exercise == "exercise7")
+        GenerateExercise7(options, random, std::cout);
+    else if (options.exercise == "exercise8")
+        GenerateExercise8(options, random, std::cout);
+    else if (options.exercise == "exercise9")
+        GenerateExercise9(options, random, std::cout);
+    else if (options.exercise == "exercise10")
+        GenerateExercise10(options, random, std::cout);
+    else if (options.exercise == "exercise11")
+        GenerateExercise11(options, random, std::cout);
+    else if (options.exercise == "exercise12")
+        GenerateExercise12(options, random, std::cout);
+    else if (options.exercise == "exercise13")
+        GenerateExercise13(options, random, std::cout);
+    else if (options.exercise == "exercise14")
+        GenerateExercise14(options, random, std::cout);
+    else if (options.exercise == "exercise15")
+        GenerateExercise15(options, random, std::cout);
+    else
+    {
+        std::cerr << "Unknown exercise " << options.exercise << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+// Runs every exercise in one process on a shared thread pool and writes one combined report.
+// Every exercise starts with a task that maps and indexes its input, which then submits the
+// parse and solve as a continuation, so the inputs are read while other exercises are solving.
+//
+// Build from the repository root with the exercises linked in as a library:
+//   g++ -std=c++17 -O2 -pthread -DADVENT_OF_CODE_NO_MAIN -o aoc_runner runner/AdventOfCodeRunner.cpp
+//       AdventOfCodeExercises.cpp AdventOfCodeUtils.cpp exercise*/AdventOfCodeExercise*.cpp
+//
+// Usage:
+//   aoc_runner [--threads N] [--output report.json] [--input-root DIR] [--only exercise7]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../AdventOfCodeUtils.h"
+#include "../AdventOfCodeExercises.h"
+
+namespace
+{
+
+struct RunnerOptions
+{
+    // hardware_concurrency() is 0 when it can't tell
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string outputFilename = "runner_report.json";
+    std::string inputRoot = ".";
+    std::vector<std::string> only;
+};
+
+// One per exercise. Each is only written by the tasks of its own exercise, which run one after
+// the other, and only read once the pool is done.
+struct ExerciseRun
+{
+    std::unique_ptr<AdventOfCodeUtils::ExerciseSolver> solver;
+    std::string inputFilename;
+    std::unique_ptr<AdventOfCodeUtils::MappedTextFile> lines;
+    AdventOfCodeUtils::Answers answers;
+    bool succeeded = false;
+
+    // Offsets from the start of the run, so the report shows what overlapped with what
+    uint64_t readStartNs = 0;
+    uint64_t readNs = 0;
+    uint64_t parseNs = 0;
+    uint64_t solveNs = 0;
+};
+
+uint64_t ElapsedNs(const std::chrono::steady_clock::time_point start)
+{
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+bool ParseOptions(int argc, char** argv, RunnerOptions& options /* out */)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument(argv[i]);
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--threads" && hasValue)
+        {
+            if (!AdventOfCodeUtils::ParseInteger(argv[++i], options.threads) || options.threads == 0)
+                return false;
+        }
+        else if (argument == "--output" && hasValue)
+        {
+            options.outputFilename = argv[++i];
+        }
+        else if (argument == "--input-root" && hasValue)
+        {
+            options.inputRoot = argv[++i];
+        }
+        else if (argument == "--only" && hasValue)
+        {
+            options.only.push_back(argv[++i]);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SolveExercise(ExerciseRun& run)
+{
+    const auto parseStart = std::chrono::steady_clock::now();
+    run.solver->Parse(*run.lines);
+    run.parseNs = ElapsedNs(parseStart);
+
+    const auto solveStart = std::chrono::steady_clock::now();
+    run.answers = run.solver->Solve();
+    run.solveNs = ElapsedNs(solveStart);
+    run.succeeded = true;
+}
+
+void PrefetchAndSolveExercise(
+    AdventOfCodeUtils::ThreadPool& pool,
+    const std::chrono::steady_clock::time_point runStart,
+    ExerciseRun& run)
+{
+    run.readStartNs = ElapsedNs(runStart);
+
+    // Mapping the file also indexes every line, so by the time the solve task runs the whole
+    // input has been paged in
+    const auto readStart = std::chrono::steady_clock::now();
+    run.lines = std::make_unique<AdventOfCodeUtils::MappedTextFile>(run.inputFilename);
+    run.readNs = ElapsedNs(readStart);
+    if (!run.lines->IsOpen())
+        return;
+
+    pool.Submit([&run] { SolveExercise(run); });
+}
+
+void WriteReport(const RunnerOptions& options, const std::vector<ExerciseRun>& runs, const uint64_t wallNs)
+{
+    std::ofstream output(options.outputFilename);
+    output << "{\n";
+    output << "  \"threads\": " << options.threads << ",\n";
+    output << "  \"wall_ns\": " << wallNs << ",\n";
+    output << "  \"exercises\": [\n";
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const auto& run = runs[i];
+        output << "    {\n";
+        output << "      \"name\": " << AdventOfCodeUtils::EscapeJsonString(run.solver->GetName()) << ",\n";
+        output << "      \"input\": " << AdventOfCodeUtils::EscapeJsonString(run.inputFilename) << ",\n";
+        output << "      \"succeeded\": " << (run.succeeded ? "true" : "false") << ",\n";
+        output << "      \"answers\": { \"part1\": " << AdventOfCodeUtils::EscapeJsonString(run.answers.part1)
+               << ", \"part2\": " << AdventOfCodeUtils::EscapeJsonString(run.answers.part2) << " },\n";
+        output << "      \"start_ns\": " << run.readStartNs
+               << ", \"read_ns\": " << run.readNs
+               << ", \"parse_ns\": " << run.parseNs
+               << ", \"solve_ns\": " << run.solveNs << "\n";
+        output << "    }" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    output << "  ]\n";
+    output << "}\n";
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    RunnerOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--threads N] [--output FILE] [--input-root DIR] [--only NAME]" << std::endl;
+        return 1;
+    }
+
+    std::vector<ExerciseRun> runs;
+    for (const auto& exercise : AdventOfCodeExercises::GetExercises())
+    {
+        if (!options.only.empty() &&
+            std::find(options.only.begin(), options.only.end(), exercise.directory) == options.only.end())
+        {
+            continue;
+        }
+
+        ExerciseRun run;
+        run.solver = exercise.create();
+        run.inputFilename = options.inputRoot + "/" + exercise.directory + "/" + run.solver->GetInputFilename();
+        runs.push_back(std::move(run));
+    }
+
+    // The vector isn't touched again until the pool is done, so the tasks can hold references
+    const auto runStart = std::chrono::steady_clock::now();
+    {
+        AdventOfCodeUtils::ThreadPool pool(options.threads);
+        for (auto& run : runs)
+        {
+            pool.Submit([&pool, runStart, &run] { PrefetchAndSolveExercise(pool, runStart, run); });
+        }
+
+        pool.Wait();
+    }
+    const auto wallNs = ElapsedNs(runStart);
+
+    bool allSucceeded = true;
+    uint64_t sumNs = 0;
+    uint64_t slowestNs = 0;
+    for (const auto& run : runs)
+    {
+        const auto totalNs = run.readNs + run.parseNs + run.solveNs;
+        sumNs += totalNs;
+        slowestNs = std::max(slowestNs, totalNs);
+
+        std::cout << run.solver->GetName() << "  " << totalNs / 1000.0 << "us" << std::endl;
+        if (!run.succeeded)
+        {
+            std::cerr << "  Unable to open " << run.inputFilename << std::endl;
+            allSucceeded = false;
+            continue;
+        }
+
+        if (!run.answers.part1.empty())
+            std::cout << "  Part 1: " << run.answers.part1 << std::endl;
+
+        if (!run.answers.part2.empty())
+        {
+            // Multi-line answers (the exercise 10 image) start on their own line
+            const auto multiLine = run.answers.part2.find('\n') != std::string::npos;
+            std::cout << "  Part 2:" << (multiLine ? "\n" : " ") << run.answers.part2 << std::endl;
+        }
+    }
+
+    std::cout << "Wall " << wallNs / 1000.0 << "us on " << options.threads << " threads"
+              << ", sum of exercises " << sumNs / 1000.0 << "us"
+              << ", slowest exercise " << slowestNs / 1000.0 << "us" << std::endl;
+
+    WriteReport(options, runs, wallNs);
+    return allSucceeded ? 0 : 1;
+}